@@ -0,0 +1,946 @@
+// for syscall/sysconf extras
+#define _DEFAULT_SOURCE
+
+#include "base.h"
+#include "memory/memory.h"
+#include "memory/queue.h"
+#include "memory/slab.h"
+#include "util/sort.h"
+#include "platform/platform.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+// standalone microbenchmarks for the memory containers
+// no glfw/gl in here, build and run with `make bench-memory`
+// the tables get printed as they go, the container suite at the end is written out as csv
+
+enum {
+    BENCH_LOOKUPS = 1 << 22,
+};
+
+// xorshift, good enough to scramble access patterns
+static u32 bench_rng = 0x9e3779b9;
+static u32 bench_rand() {
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 17;
+    bench_rng ^= bench_rng << 5;
+    return bench_rng;
+}
+
+static void bench_shuffle(handle_t* handles, u32 count) {
+    for(u32 i = count - 1; i > 0; i --) {
+        u32 j = bench_rand() % (i + 1);
+        handle_t tmp = handles[i];
+        handles[i] = handles[j];
+        handles[j] = tmp;
+    }
+}
+
+// POOLS
+static void bench_pool_get() {
+    printf("pool_get (%u random lookups per size)\n", BENCH_LOOKUPS);
+    printf("%10s %12s\n", "live", "ns/op");
+
+    for(u32 live = 16; live <= (1 << 16); live *= 4) {
+        pool_t pool = pool_alloc_new(live, sizeof(u64));
+        handle_t* handles = mem_alloc(live * sizeof(handle_t));
+
+        for(u32 i = 0; i < live; i ++) {
+            u64* data = pool_push(&pool, &handles[i]);
+            *data = i;
+        }
+
+        bench_shuffle(handles, live);
+
+        u64 sum = 0;
+        u64 start = platform_get_ticks();
+        for(u32 i = 0; i < BENCH_LOOKUPS; i ++) {
+            u64* data = pool_get(&pool, handles[i & (live - 1)]);
+            sum += *data;
+        }
+        u64 ticks = platform_get_ticks() - start;
+
+        // print the sum so the loop doesnt get optimised away
+        printf("%10u %12.2f   (checksum %llu)\n", live, (f64) ticks / BENCH_LOOKUPS, (unsigned long long) sum);
+
+        mem_free(handles);
+        pool_destroy(&pool);
+    }
+}
+
+// frees a random live element and pushes a new one in its place,
+// like projectiles/particles getting spawned and destroyed every frame
+static void bench_pool_churn() {
+    printf("pool_free + pool_push churn (%u pairs per size, half full)\n", BENCH_LOOKUPS);
+    printf("%10s %12s\n", "capacity", "ns/op");
+
+    for(u32 capacity = 16; capacity <= (1 << 16); capacity *= 4) {
+        pool_t pool = pool_alloc_new(capacity, sizeof(u64));
+        u32 live = capacity / 2;
+        handle_t* handles = mem_alloc(live * sizeof(handle_t));
+
+        for(u32 i = 0; i < live; i ++) {
+            u64* data = pool_push(&pool, &handles[i]);
+            *data = i;
+        }
+
+        u64 start = platform_get_ticks();
+        for(u32 i = 0; i < BENCH_LOOKUPS; i ++) {
+            u32 victim = bench_rand() & (live - 1);
+            pool_free(&pool, handles[victim]);
+            u64* data = pool_push(&pool, &handles[victim]);
+            *data = i;
+        }
+        u64 ticks = platform_get_ticks() - start;
+
+        printf("%10u %12.2f   (live %u)\n", capacity, (f64) ticks / BENCH_LOOKUPS, pool.num_in_use);
+
+        mem_free(handles);
+        pool_destroy(&pool);
+    }
+}
+
+// walks a 4096 slot pool at different fill ratios,
+// once element by element and once a run at a time
+static void bench_pool_iter() {
+    enum { CAPACITY = 4096, PASSES = 1024 };
+    printf("pool_iter vs pool_iter_runs (%u slots, %u passes)\n", CAPACITY, PASSES);
+    printf("%10s %14s %14s\n", "fill %", "iter ns/pass", "runs ns/pass");
+
+    u32 fills[] = { 1, 5, 25, 50, 90, 100 };
+    for(u32 f = 0; f < ARRAY_SIZE(fills); f ++) {
+        pool_t pool = pool_alloc_new(CAPACITY, sizeof(u64));
+        handle_t handle;
+        for(u32 i = 0; i < CAPACITY; i ++) {
+            u64* data = pool_push(&pool, &handle);
+            *data = i;
+        }
+
+        // free a random spread of elements until we hit the fill ratio
+        u32 target = CAPACITY * fills[f] / 100;
+        while(pool.num_in_use > target) {
+            u32 index = bench_rand() & (CAPACITY - 1);
+            pool_free(&pool, pool_handle_at_index(&pool, index));
+        }
+
+        u64 sum = 0;
+        u64 start = platform_get_ticks();
+        for(u32 p = 0; p < PASSES; p ++) {
+            pool_iter_t iter = {0};
+            while(pool_iter(&pool, &iter)) sum += *(u64*) iter.data;
+        }
+        u64 iter_ticks = platform_get_ticks() - start;
+
+        start = platform_get_ticks();
+        for(u32 p = 0; p < PASSES; p ++) {
+            pool_run_iter_t iter = {0};
+            while(pool_iter_runs(&pool, &iter)) {
+                u64* data = iter.run.data;
+                for(u32 i = 0; i < iter.run.count; i ++) sum += data[i];
+            }
+        }
+        u64 runs_ticks = platform_get_ticks() - start;
+
+        printf("%10u %14.1f %14.1f   (checksum %llu)\n", fills[f], (f64) iter_ticks / PASSES, (f64) runs_ticks / PASSES, (unsigned long long) sum);
+        pool_destroy(&pool);
+    }
+}
+
+// HASH MAPS
+typedef struct bench_entry_t {
+    u64 key;
+    u32 value;
+} bench_entry_t;
+
+// looks up random present keys in a hash map and by scanning a vector of key/value pairs
+// the scans get fewer lookups at bigger sizes so this doesnt take all day
+static void bench_hashmap_vs_scan() {
+    printf("hashmap_get_u64 vs vector scan (random present keys)\n");
+    printf("%10s %12s %12s\n", "entries", "map ns/op", "scan ns/op");
+
+    for(u32 entries = 4; entries <= (1 << 16); entries *= 4) {
+        hashmap_t map = hashmap_alloc_new(entries, sizeof(u64), sizeof(u32));
+        vector_t vector = vector_alloc_new(entries, sizeof(bench_entry_t));
+        u64* keys = mem_alloc(entries * sizeof(u64));
+
+        for(u32 i = 0; i < entries; i ++) {
+            // spread the keys out like packed ids would be
+            keys[i] = ((u64) bench_rand() << 32) | i;
+            hashmap_put_u64(&map, keys[i], &i);
+            vector_push_data(&vector, &(bench_entry_t) { .key = keys[i], .value = i });
+        }
+
+        u64 sum = 0;
+        u64 start = platform_get_ticks();
+        for(u32 i = 0; i < BENCH_LOOKUPS; i ++) {
+            u32* value = hashmap_get_u64(&map, keys[i & (entries - 1)]);
+            sum += *value;
+        }
+        u64 map_ticks = platform_get_ticks() - start;
+
+        u32 scans = MAX(BENCH_LOOKUPS / entries, 64);
+        start = platform_get_ticks();
+        for(u32 i = 0; i < scans; i ++) {
+            u64 key = keys[bench_rand() & (entries - 1)];
+            bench_entry_t* data = vector.data;
+            for(u32 j = 0; j < vector.size; j ++) {
+                if(data[j].key == key) {
+                    sum += data[j].value;
+                    break;
+                }
+            }
+        }
+        u64 scan_ticks = platform_get_ticks() - start;
+
+        printf("%10u %12.2f %12.2f   (checksum %llu)\n", entries, (f64) map_ticks / BENCH_LOOKUPS, (f64) scan_ticks / scans, (unsigned long long) sum);
+
+        mem_free(keys);
+        vector_destroy(&vector);
+        hashmap_destroy(&map);
+    }
+}
+
+// ALLOCATOR
+typedef void* (*bench_alloc_fn)(usize bytes);
+typedef void (*bench_free_fn)(void* ptr);
+
+static void* bench_libc_alloc(usize bytes) { return malloc(bytes); }
+static void bench_libc_free(void* ptr) { free(ptr); }
+static void* bench_slab_alloc(usize bytes) { return slab_alloc(bytes); }
+static void bench_slab_free(void* ptr) { slab_free(ptr); }
+
+// frees and reallocates random slots with random small sizes, timed in batches
+// so we get the worst batch as well as the average, which is what shows up as a frame spike
+static void bench_alloc_churn_with(const char* name, bench_alloc_fn alloc, bench_free_fn dealloc) {
+    enum { SLOTS = 4096, BATCH = 256, BATCHES = BENCH_LOOKUPS / BATCH };
+
+    void** ptrs = calloc(SLOTS, sizeof(void*));
+    for(u32 i = 0; i < SLOTS; i ++) ptrs[i] = alloc(16 + bench_rand() % 1024);
+
+    u64 total = 0;
+    u64 worst = 0;
+    for(u32 b = 0; b < BATCHES; b ++) {
+        u64 start = platform_get_ticks();
+        for(u32 i = 0; i < BATCH; i ++) {
+            u32 slot = bench_rand() & (SLOTS - 1);
+            dealloc(ptrs[slot]);
+            ptrs[slot] = alloc(16 + bench_rand() % 1024);
+        }
+        u64 ticks = platform_get_ticks() - start;
+        total += ticks;
+        worst = MAX(worst, ticks);
+    }
+
+    printf("%10s %12.2f %16.2f\n", name, (f64) total / (BATCHES * BATCH), (f64) worst / BATCH);
+
+    for(u32 i = 0; i < SLOTS; i ++) dealloc(ptrs[i]);
+    free(ptrs);
+}
+
+static void bench_alloc_churn() {
+    printf("free + alloc churn (4096 live, 16..1040 bytes, %u pairs)\n", BENCH_LOOKUPS);
+    printf("%10s %12s %16s\n", "allocator", "avg ns/op", "worst batch ns/op");
+
+    bench_alloc_churn_with("libc", bench_libc_alloc, bench_libc_free);
+    bench_alloc_churn_with("slab", bench_slab_alloc, bench_slab_free);
+
+    slab_stats_t stats = slab_get_stats();
+    printf("slab: %zu bytes committed, %zu bytes in free lists, %llu allocations total, %.1f%% fragmentation\n",
+           stats.committed_bytes, stats.free_bytes, (unsigned long long) stats.total_allocations, stats.fragmentation * 100.0f);
+}
+
+// QUEUES
+// threads yield when the queue is full/empty instead of spinning, so this still finishes
+// in a reasonable time on machines with fewer cores than threads
+// every producer pushes its id in the top bits and a running count in the bottom,
+// consumers add up everything they pop so we can check nothing got lost or duplicated
+enum {
+    QUEUE_ITEMS = 1 << 22,
+    QUEUE_CAPACITY = 1024,
+    QUEUE_MAX_THREADS = 8,
+};
+
+typedef struct bench_queue_ctx_t {
+    spsc_queue_t spsc;
+    mpmc_queue_t mpmc;
+
+    u32 items_per_producer;
+    _Atomic u64 consumed;
+    _Atomic u64 checksum;
+} bench_queue_ctx_t;
+
+typedef struct bench_queue_thread_t {
+    bench_queue_ctx_t* ctx;
+    u64 id;
+    u64 total_items;
+} bench_queue_thread_t;
+
+static void* bench_spsc_producer(void* arg) {
+    bench_queue_thread_t* thread = arg;
+    for(u64 i = 0; i < thread->ctx->items_per_producer; i ++) {
+        while(!spsc_queue_push(&thread->ctx->spsc, &i)) sched_yield();
+    }
+
+    return NULL;
+}
+
+static void* bench_spsc_consumer(void* arg) {
+    bench_queue_thread_t* thread = arg;
+    u64 sum = 0;
+    u64 expected = 0;
+    for(u64 i = 0; i < thread->total_items; i ++) {
+        u64 item;
+        while(!spsc_queue_pop(&thread->ctx->spsc, &item)) sched_yield();
+        // only one producer, so order has to be kept exactly
+        if(item != expected) PANIC("spsc queue out of order, got [%llu] expected [%llu]\n", (unsigned long long) item, (unsigned long long) expected);
+        expected ++;
+        sum += item;
+    }
+
+    atomic_fetch_add(&thread->ctx->checksum, sum);
+    atomic_fetch_add(&thread->ctx->consumed, thread->total_items);
+    return NULL;
+}
+
+static void* bench_mpmc_producer(void* arg) {
+    bench_queue_thread_t* thread = arg;
+    for(u64 i = 0; i < thread->ctx->items_per_producer; i ++) {
+        u64 item = (thread->id << 32) | i;
+        while(!mpmc_queue_push(&thread->ctx->mpmc, &item)) sched_yield();
+    }
+
+    return NULL;
+}
+
+static void* bench_mpmc_consumer(void* arg) {
+    bench_queue_thread_t* thread = arg;
+    u64 sum = 0;
+    // one past the last index seen from each producer, 0 if nothing from it yet
+    u64 next[QUEUE_MAX_THREADS] = {0};
+    // keep going until every item has been taken by someone
+    while(atomic_load(&thread->ctx->consumed) < thread->total_items) {
+        u64 item;
+        if(!mpmc_queue_pop(&thread->ctx->mpmc, &item)) {
+            sched_yield();
+            continue;
+        }
+
+        // items from one producer can be split between consumers, but each consumer
+        // still has to see them in the order they were pushed
+        u64 producer = item >> 32;
+        u64 index = item & 0xFFFFFFFF;
+        if(producer >= QUEUE_MAX_THREADS) PANIC("mpmc queue gave back garbage [%llx]\n", (unsigned long long) item);
+        if(index < next[producer])
+            PANIC("mpmc queue out of order for producer [%llu], got [%llu] after [%llu]\n",
+                  (unsigned long long) producer, (unsigned long long) index, (unsigned long long) next[producer] - 1);
+        next[producer] = index + 1;
+
+        sum += item;
+        atomic_fetch_add(&thread->ctx->consumed, 1);
+    }
+
+    atomic_fetch_add(&thread->ctx->checksum, sum);
+    return NULL;
+}
+
+static u64 bench_queue_expected_checksum(u32 producers, u32 items_per_producer) {
+    u64 sum = 0;
+    for(u64 p = 0; p < producers; p ++) {
+        sum += (p << 32) * items_per_producer;
+        sum += (u64) items_per_producer * (items_per_producer - 1) / 2;
+    }
+
+    return sum;
+}
+
+static void bench_spsc_queue() {
+    printf("spsc queue (%u items, capacity %u)\n", QUEUE_ITEMS, QUEUE_CAPACITY);
+    printf("%12s %12s\n", "ns/item", "Mitems/s");
+
+    arena_t arena = arena_alloc_new(MEGABYTES(1));
+    bench_queue_ctx_t ctx = {
+        .spsc = arena_spsc_queue_push(&arena, QUEUE_CAPACITY, sizeof(u64)),
+        .items_per_producer = QUEUE_ITEMS,
+    };
+
+    bench_queue_thread_t producer = { .ctx = &ctx, .id = 0 };
+    bench_queue_thread_t consumer = { .ctx = &ctx, .total_items = QUEUE_ITEMS };
+
+    u64 start = platform_get_ticks();
+    pthread_t threads[2];
+    pthread_create(&threads[0], NULL, bench_spsc_consumer, &consumer);
+    pthread_create(&threads[1], NULL, bench_spsc_producer, &producer);
+    pthread_join(threads[0], NULL);
+    pthread_join(threads[1], NULL);
+    u64 ticks = platform_get_ticks() - start;
+
+    if(ctx.checksum != bench_queue_expected_checksum(1, QUEUE_ITEMS)) PANIC("spsc queue checksum mismatch\n");
+
+    printf("%12.2f %12.2f\n", (f64) ticks / QUEUE_ITEMS, QUEUE_ITEMS / (ticks / 1000.0));
+    arena_destroy(&arena);
+}
+
+static void bench_mpmc_queue() {
+    printf("mpmc queue (%u items total, capacity %u, same number of consumers as producers)\n", QUEUE_ITEMS, QUEUE_CAPACITY);
+    printf("%10s %12s %12s\n", "producers", "ns/item", "Mitems/s");
+
+    for(u32 producers = 1; producers <= QUEUE_MAX_THREADS / 2; producers *= 2) {
+        arena_t arena = arena_alloc_new(MEGABYTES(1));
+        bench_queue_ctx_t ctx = {
+            .mpmc = arena_mpmc_queue_push(&arena, QUEUE_CAPACITY, sizeof(u64)),
+            .items_per_producer = QUEUE_ITEMS / producers,
+        };
+
+        u32 total = ctx.items_per_producer * producers;
+        bench_queue_thread_t args[QUEUE_MAX_THREADS];
+        pthread_t threads[QUEUE_MAX_THREADS];
+
+        u64 start = platform_get_ticks();
+        for(u32 i = 0; i < producers; i ++) {
+            args[i] = (bench_queue_thread_t) { .ctx = &ctx, .id = i };
+            pthread_create(&threads[i], NULL, bench_mpmc_producer, &args[i]);
+        }
+
+        for(u32 i = producers; i < producers * 2; i ++) {
+            args[i] = (bench_queue_thread_t) { .ctx = &ctx, .total_items = total };
+            pthread_create(&threads[i], NULL, bench_mpmc_consumer, &args[i]);
+        }
+
+        for(u32 i = 0; i < producers * 2; i ++) pthread_join(threads[i], NULL);
+        u64 ticks = platform_get_ticks() - start;
+
+        if(ctx.consumed != total) PANIC("mpmc queue lost items, got [%llu] of [%u]\n", (unsigned long long) ctx.consumed, total);
+        if(ctx.checksum != bench_queue_expected_checksum(producers, ctx.items_per_producer)) PANIC("mpmc queue checksum mismatch\n");
+
+        printf("%10u %12.2f %12.2f\n", producers, (f64) ticks / total, total / (ticks / 1000.0));
+        arena_destroy(&arena);
+    }
+}
+
+// SORTING
+static int bench_qsort_compare(const void* a, const void* b) {
+    u64 ka = ((const sort_key_t*) a)->key;
+    u64 kb = ((const sort_key_t*) b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+// random keys using the bottom `bits` bits
+// payloads are the original index, so stability can be checked too
+static void bench_fill_keys(sort_key_t* keys, u32 count, u32 bits) {
+    for(u32 i = 0; i < count; i ++) {
+        u64 key = ((u64) bench_rand() << 32) | bench_rand();
+        keys[i] = (sort_key_t) { .key = key >> (64 - bits), .payload = i };
+    }
+}
+
+static void bench_check_sorted(sort_key_t* keys, u32 count) {
+    for(u32 i = 1; i < count; i ++) {
+        if(keys[i - 1].key > keys[i].key) PANIC("keys not sorted at [%u]\n", i);
+        if(keys[i - 1].key == keys[i].key && keys[i - 1].payload > keys[i].payload)
+            PANIC("sort not stable at [%u]\n", i);
+    }
+}
+
+static void bench_radix_sort() {
+    printf("radix sort vs qsort (sort_key_t, ns per key)\n");
+    printf("%10s %8s %12s %12s\n", "keys", "bits", "radix", "qsort");
+
+    u32 max_count = 1 << 20;
+    arena_t scratch = arena_alloc_new(max_count * sizeof(sort_key_t) + CACHE_LINE_SIZE);
+    sort_key_t* source = mem_alloc(max_count * sizeof(sort_key_t));
+    sort_key_t* keys = mem_alloc(max_count * sizeof(sort_key_t));
+
+    // 16 bits repeats a lot, like a layer + shader key would
+    u32 bits[] = { 16, 32, 64 };
+
+    for(u32 b = 0; b < ARRAY_SIZE(bits); b ++) {
+        for(u32 count = 16; count <= max_count; count *= 4) {
+            bench_fill_keys(source, count, bits[b]);
+            u32 reps = MAX(1u, (1u << 22) / count);
+
+            u64 radix_ticks = 0;
+            for(u32 r = 0; r < reps; r ++) {
+                memcpy(keys, source, count * sizeof(sort_key_t));
+                u64 start = platform_get_ticks();
+                radix_sort_keys(keys, count, &scratch);
+                radix_ticks += platform_get_ticks() - start;
+            }
+
+            bench_check_sorted(keys, count);
+
+            u64 qsort_ticks = 0;
+            for(u32 r = 0; r < reps; r ++) {
+                memcpy(keys, source, count * sizeof(sort_key_t));
+                u64 start = platform_get_ticks();
+                qsort(keys, count, sizeof(sort_key_t), bench_qsort_compare);
+                qsort_ticks += platform_get_ticks() - start;
+            }
+
+            f64 total = (f64) count * reps;
+            printf("%10u %8u %12.2f %12.2f\n", count, bits[b], radix_ticks / total, qsort_ticks / total);
+        }
+    }
+
+    mem_free(keys);
+    mem_free(source);
+    arena_destroy(&scratch);
+}
+
+// CONTAINER SUITE
+// times the core container operations across sizes, access patterns and fill ratios,
+// and writes one csv row per measurement so runs from before and after a change can be diffed
+//
+// cache misses come from the cpu's counters (perf_event_open) when the kernel lets us have them
+// otherwise theyre modelled: random accesses miss with the odds of the working set not fitting in the
+// last level cache, sequential ones only miss once per line. the miss_source column says which one it was
+enum {
+    SUITE_OPS = 1 << 20, // rough number of operations per row
+    SUITE_NUM_SIZES = 3,
+};
+
+static const u32 suite_sizes[SUITE_NUM_SIZES] = { 1 << 10, 1 << 14, 1 << 18 };
+
+// 32 bytes, half a cache line
+typedef struct suite_elem_t {
+    u64 a, b, c, d;
+} suite_elem_t;
+
+typedef enum suite_access_t {
+    SUITE_ACCESS_SEQUENTIAL = 0,
+    SUITE_ACCESS_RANDOM,
+} suite_access_t;
+
+typedef struct suite_row_t {
+    const char* container;
+    const char* op;
+    const char* pattern;
+    u32 size; // elements, or bytes per push for arenas
+    u32 fill; // percent of the capacity in use
+    suite_access_t access;
+    // bytes the measured loop works over, and cache lines each op touches
+    usize working_set;
+    f32 lines_per_op;
+} suite_row_t;
+
+typedef struct suite_ctx_t {
+    FILE* out;
+    i32 perf_fd;
+    usize llc_size;
+    u64 sink; // results get added in here so the loops dont get optimised away
+} suite_ctx_t;
+
+static suite_ctx_t suite = {0};
+
+static i32 suite_perf_open() {
+    struct perf_event_attr attr = {0};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // this thread, any cpu
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void suite_begin(FILE* out) {
+    suite.out = out;
+    suite.perf_fd = suite_perf_open();
+
+    i64 llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if(llc <= 0) llc = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    suite.llc_size = llc > 0 ? (usize) llc : MEGABYTES(8);
+
+    fprintf(out, "container,op,pattern,size,fill_pct,ops,ns_per_op,cache_misses_per_op,miss_source,working_set_bytes\n");
+}
+
+static void suite_end() {
+    if(suite.perf_fd >= 0) close(suite.perf_fd);
+    printf("container suite done (%s cache misses, checksum %llu)\n",
+           suite.perf_fd >= 0 ? "measured" : "modelled", (unsigned long long) suite.sink);
+}
+
+typedef struct suite_timer_t {
+    u64 ticks;
+    u64 misses;
+    u64 start_ticks;
+} suite_timer_t;
+
+// timers can be started and stopped a bunch of times, so setup work in between doesnt get counted
+static void suite_timer_start(suite_timer_t* timer) {
+    if(suite.perf_fd >= 0) {
+        ioctl(suite.perf_fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(suite.perf_fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    timer->start_ticks = platform_get_ticks();
+}
+
+static void suite_timer_stop(suite_timer_t* timer) {
+    timer->ticks += platform_get_ticks() - timer->start_ticks;
+
+    if(suite.perf_fd >= 0) {
+        ioctl(suite.perf_fd, PERF_EVENT_IOC_DISABLE, 0);
+        u64 count = 0;
+        if(read(suite.perf_fd, &count, sizeof(count)) == sizeof(count)) timer->misses += count;
+    }
+}
+
+static f64 suite_model_misses(suite_row_t row) {
+    if(row.working_set <= suite.llc_size) return 0.0;
+
+    f64 miss_chance = 1.0 - (f64) suite.llc_size / row.working_set;
+    if(row.access == SUITE_ACCESS_RANDOM) return row.lines_per_op * miss_chance;
+
+    // the prefetcher hides most of a sequential walk, but every line still has to come in once
+    return row.lines_per_op;
+}
+
+static void suite_report(suite_row_t row, suite_timer_t timer, u64 ops) {
+    f64 misses = suite.perf_fd >= 0 ? (f64) timer.misses / ops : suite_model_misses(row);
+
+    fprintf(suite.out, "%s,%s,%s,%u,%u,%llu,%.3f,%.4f,%s,%zu\n",
+            row.container, row.op, row.pattern, row.size, row.fill, (unsigned long long) ops,
+            (f64) timer.ticks / ops, misses, suite.perf_fd >= 0 ? "perf" : "model", row.working_set);
+}
+
+static u32 suite_reps(u32 ops_per_rep) {
+    return MAX(1u, SUITE_OPS / MAX(ops_per_rep, 1u));
+}
+
+// fills a pool to capacity, then frees random elements until only fill% are left
+// handles of the live elements end up in handles[0, return)
+static u32 suite_pool_fill(pool_t* pool, handle_t* handles, u32 fill) {
+    pool_clear(pool);
+    for(u32 i = 0; i < pool->capacity; i ++) {
+        suite_elem_t* elem = pool_push(pool, &handles[i]);
+        elem->a = i;
+    }
+
+    bench_shuffle(handles, pool->capacity);
+
+    u32 live = (u32) ((u64) pool->capacity * fill / 100);
+    for(u32 i = live; i < pool->capacity; i ++) pool_free(pool, handles[i]);
+    return live;
+}
+
+static usize suite_pool_bytes(u32 capacity) {
+    return pool_block_size(capacity, sizeof(suite_elem_t));
+}
+
+static void suite_pool() {
+    static const u32 fills[] = { 25, 50, 90, 100 };
+
+    for(u32 s = 0; s < SUITE_NUM_SIZES; s ++) {
+        u32 size = suite_sizes[s];
+        pool_t pool = pool_alloc_new(size, sizeof(suite_elem_t));
+        handle_t* handles = mem_alloc(size * sizeof(handle_t));
+        usize bytes = suite_pool_bytes(size);
+
+        // push into an empty pool until its full
+        {
+            suite_timer_t timer = {0};
+            u32 reps = suite_reps(size);
+            for(u32 r = 0; r < reps; r ++) {
+                pool_clear(&pool);
+                suite_timer_start(&timer);
+                for(u32 i = 0; i < size; i ++) {
+                    suite_elem_t* elem = pool_push(&pool, &handles[i]);
+                    elem->a = i;
+                }
+                suite_timer_stop(&timer);
+            }
+
+            suite_report((suite_row_t) { "pool", "push", "empty_to_full", size, 100, SUITE_ACCESS_SEQUENTIAL, bytes, 1.0f }, timer, (u64) reps * size);
+        }
+
+        // pushing into the holes left by random frees, the free list jumps all over the pool
+        {
+            suite_timer_t timer = {0};
+            u32 reps = suite_reps(size / 2);
+            for(u32 r = 0; r < reps; r ++) {
+                u32 live = suite_pool_fill(&pool, handles, 50);
+                suite_timer_start(&timer);
+                for(u32 i = live; i < size; i ++) {
+                    suite_elem_t* elem = pool_push(&pool, &handles[i]);
+                    elem->a = i;
+                }
+                suite_timer_stop(&timer);
+            }
+
+            suite_report((suite_row_t) { "pool", "push", "into_holes", size, 50, SUITE_ACCESS_RANDOM, bytes, 2.0f }, timer, (u64) reps * (size - size / 2));
+        }
+
+        for(u32 f = 0; f < ARRAY_SIZE(fills); f ++) {
+            u32 live = suite_pool_fill(&pool, handles, fills[f]);
+
+            // lookups in random order
+            suite_timer_t timer = {0};
+            suite_timer_start(&timer);
+            for(u32 i = 0; i < SUITE_OPS; i ++) {
+                suite_elem_t* elem = pool_get(&pool, handles[i % live]);
+                suite.sink += elem->a;
+            }
+            suite_timer_stop(&timer);
+            suite_report((suite_row_t) { "pool", "get", "random", size, fills[f], SUITE_ACCESS_RANDOM, bytes, 2.0f }, timer, SUITE_OPS);
+
+            // full walks
+            timer = (suite_timer_t) {0};
+            u32 reps = suite_reps(size);
+            u64 visited = 0;
+            suite_timer_start(&timer);
+            for(u32 r = 0; r < reps; r ++) {
+                pool_iter_t iter = {0};
+                while(pool_iter(&pool, &iter)) {
+                    suite.sink += ((suite_elem_t*) iter.data)->a;
+                    visited ++;
+                }
+            }
+            suite_timer_stop(&timer);
+            suite_report((suite_row_t) { "pool", "iter", "full_walk", size, fills[f], SUITE_ACCESS_SEQUENTIAL,
+                                         bytes, (f32) sizeof(suite_elem_t) / CACHE_LINE_SIZE }, timer, MAX(visited, 1));
+        }
+
+        // lookups in the order the elements were pushed
+        {
+            pool_clear(&pool);
+            for(u32 i = 0; i < size; i ++) pool_push(&pool, &handles[i]);
+
+            suite_timer_t timer = {0};
+            suite_timer_start(&timer);
+            for(u32 i = 0; i < SUITE_OPS; i ++) {
+                suite_elem_t* elem = pool_get(&pool, handles[i & (size - 1)]);
+                suite.sink += elem->a;
+            }
+            suite_timer_stop(&timer);
+            suite_report((suite_row_t) { "pool", "get", "sequential", size, 100, SUITE_ACCESS_SEQUENTIAL,
+                                         bytes, (f32) sizeof(suite_elem_t) / CACHE_LINE_SIZE }, timer, SUITE_OPS);
+        }
+
+        // freeing everything in random order
+        {
+            suite_timer_t timer = {0};
+            u32 reps = suite_reps(size);
+            for(u32 r = 0; r < reps; r ++) {
+                suite_pool_fill(&pool, handles, 100);
+                suite_timer_start(&timer);
+                for(u32 i = 0; i < size; i ++) pool_free(&pool, handles[i]);
+                suite_timer_stop(&timer);
+            }
+
+            suite_report((suite_row_t) { "pool", "free", "random", size, 100, SUITE_ACCESS_RANDOM, bytes, 2.0f }, timer, (u64) reps * size);
+        }
+
+        // free + push pairs at half full
+        // random frees whatever, fifo always frees the oldest element (like particles with a fixed lifetime)
+        for(u32 pattern = 0; pattern < 2; pattern ++) {
+            u32 live = suite_pool_fill(&pool, handles, 50);
+
+            suite_timer_t timer = {0};
+            suite_timer_start(&timer);
+            for(u32 i = 0; i < SUITE_OPS; i ++) {
+                u32 victim = pattern == 0 ? bench_rand() % live : i % live;
+                pool_free(&pool, handles[victim]);
+                suite_elem_t* elem = pool_push(&pool, &handles[victim]);
+                elem->a = i;
+            }
+            suite_timer_stop(&timer);
+
+            suite_report((suite_row_t) { "pool", "churn", pattern == 0 ? "random" : "fifo", size, 50,
+                                         pattern == 0 ? SUITE_ACCESS_RANDOM : SUITE_ACCESS_SEQUENTIAL, bytes, 2.0f }, timer, SUITE_OPS);
+        }
+
+        mem_free(handles);
+        pool_destroy(&pool);
+    }
+}
+
+static void suite_arena() {
+    static const u32 push_sizes[] = { 16, 64, 256 };
+    const usize capacity = MEGABYTES(16);
+
+    arena_t arena = arena_alloc_new(capacity);
+    for(u32 p = 0; p < ARRAY_SIZE(push_sizes); p ++) {
+        u32 bytes = push_sizes[p];
+
+        // push until full, clear, go again
+        for(u32 aligned = 0; aligned < 2; aligned ++) {
+            suite_timer_t timer = {0};
+            u64 ops = 0;
+            suite_timer_start(&timer);
+            while(ops < SUITE_OPS) {
+                arena_clear(&arena);
+                for(;;) {
+                    // odd sized pushes, so the aligned version actually has to pad
+                    u8* data = aligned ? arena_push_aligned(&arena, bytes - 4, 64) : arena_push(&arena, bytes - 4);
+                    if(!data) break;
+                    data[0] = (u8) ops;
+                    ops ++;
+                }
+            }
+            suite_timer_stop(&timer);
+
+            suite_report((suite_row_t) { "arena", "push", aligned ? "aligned_64" : "unaligned", bytes, 100, SUITE_ACCESS_SEQUENTIAL,
+                                         capacity, (f32) bytes / CACHE_LINE_SIZE }, timer, ops);
+        }
+    }
+
+    arena_destroy(&arena);
+}
+
+static void suite_vector() {
+    for(u32 s = 0; s < SUITE_NUM_SIZES; s ++) {
+        u32 size = suite_sizes[s];
+        usize bytes = (usize) size * sizeof(suite_elem_t);
+
+        // push size elements, either into a vector that already has room or one that grows as it goes
+        for(u32 pattern = 0; pattern < 2; pattern ++) {
+            suite_timer_t timer = {0};
+            u32 reps = suite_reps(size);
+            for(u32 r = 0; r < reps; r ++) {
+                vector_t vector = pattern == 0 ?
+                    vector_alloc_new(size, sizeof(suite_elem_t)) :
+                    vector_alloc_new_expand(0, sizeof(suite_elem_t), EXPAND_TYPE_AUTOEXPAND);
+
+                suite_timer_start(&timer);
+                for(u32 i = 0; i < size; i ++) {
+                    suite_elem_t* elem = vector_push(&vector);
+                    elem->a = i;
+                }
+                suite_timer_stop(&timer);
+
+                vector_destroy(&vector);
+            }
+
+            suite_report((suite_row_t) { "vector", "push", pattern == 0 ? "reserved" : "autoexpand", size, 100, SUITE_ACCESS_SEQUENTIAL,
+                                         bytes, (f32) sizeof(suite_elem_t) / CACHE_LINE_SIZE }, timer, (u64) reps * size);
+        }
+
+        // removing from a full vector
+        // front is the worst case for vector_remove, everything behind it moves
+        static const char* patterns[] = { "front", "back", "random", "swap_random" };
+        for(u32 pattern = 0; pattern < ARRAY_SIZE(patterns); pattern ++) {
+            vector_t vector = vector_alloc_new(size, sizeof(suite_elem_t));
+            // keep the O(n) ones from taking forever on the big sizes
+            u32 removals = pattern == 0 || pattern == 2 ? MIN(size, 4096u) : size;
+            u32 reps = suite_reps(removals * (pattern == 0 || pattern == 2 ? size / 64 : 1));
+
+            suite_timer_t timer = {0};
+            for(u32 r = 0; r < reps; r ++) {
+                vector_clear(&vector);
+                vector_push_n(&vector, NULL, size);
+
+                suite_timer_start(&timer);
+                for(u32 i = 0; i < removals; i ++) {
+                    switch(pattern) {
+                        case 0: vector_remove(&vector, 0); break;
+                        case 1: vector_remove(&vector, vector.size - 1); break;
+                        case 2: vector_remove(&vector, bench_rand() % vector.size); break;
+                        case 3: vector_remove_swap(&vector, bench_rand() % vector.size); break;
+                    }
+                }
+                suite_timer_stop(&timer);
+            }
+
+            // the shifting removes touch everything behind the removed element
+            f32 lines = pattern == 0 || pattern == 2 ? (f32) bytes / CACHE_LINE_SIZE / (pattern == 2 ? 2 : 1) : 2.0f;
+            suite_report((suite_row_t) { "vector", "remove", patterns[pattern], size, 100,
+                                         pattern == 1 ? SUITE_ACCESS_SEQUENTIAL : SUITE_ACCESS_RANDOM, bytes, lines }, timer, (u64) reps * removals);
+
+            vector_destroy(&vector);
+        }
+    }
+}
+
+static void suite_llist() {
+    enum { FILLER_BYTES = 256 };
+
+    for(u32 s = 0; s < SUITE_NUM_SIZES; s ++) {
+        u32 size = suite_sizes[s];
+        suite_elem_t* elems = mem_alloc(size * sizeof(suite_elem_t));
+        for(u32 i = 0; i < size; i ++) elems[i].a = i;
+
+        // packed: nodes pushed back to back
+        // interleaved: other stuff pushed into the arena between nodes, like a real frame would
+        for(u32 pattern = 0; pattern < 2; pattern ++) {
+            usize node_stride = sizeof(llist_node_t) + (pattern ? FILLER_BYTES : 0);
+            arena_t arena = arena_alloc_new((usize) size * node_stride);
+            usize bytes = (usize) size * (node_stride + sizeof(suite_elem_t));
+
+            suite_timer_t push_timer = {0};
+            u32 reps = suite_reps(size);
+            llist_t list = llist_new();
+            for(u32 r = 0; r < reps; r ++) {
+                arena_clear(&arena);
+                list = llist_new();
+
+                suite_timer_start(&push_timer);
+                for(u32 i = 0; i < size; i ++) {
+                    llist_push(&list, &arena, &elems[i]);
+                    if(pattern) arena_push(&arena, FILLER_BYTES);
+                }
+                suite_timer_stop(&push_timer);
+            }
+
+            const char* name = pattern ? "interleaved" : "packed";
+            suite_report((suite_row_t) { "llist", "push", name, size, 100, SUITE_ACCESS_SEQUENTIAL,
+                                         bytes, (f32) sizeof(llist_node_t) / CACHE_LINE_SIZE }, push_timer, (u64) reps * size);
+
+            suite_timer_t iter_timer = {0};
+            suite_timer_start(&iter_timer);
+            for(u32 r = 0; r < reps; r ++) {
+                llist_iter_t iter = {0};
+                while(llist_iter(&list, &iter)) suite.sink += ((suite_elem_t*) iter.data)->a;
+            }
+            suite_timer_stop(&iter_timer);
+
+            // a node plus the element it points at
+            f32 lines = (f32) node_stride / CACHE_LINE_SIZE + (f32) sizeof(suite_elem_t) / CACHE_LINE_SIZE;
+            suite_report((suite_row_t) { "llist", "iter", name, size, 100, SUITE_ACCESS_SEQUENTIAL,
+                                         bytes, MIN(lines, 2.0f) }, iter_timer, (u64) reps * size);
+
+            arena_destroy(&arena);
+        }
+
+        mem_free(elems);
+    }
+}
+
+// writes the csv to path, or stdout if its NULL
+static void bench_container_suite(const char* path) {
+    FILE* out = path ? fopen(path, "w") : stdout;
+    if(!out) PANIC("couldnt open [%s] for the container suite\n", path);
+
+    suite_begin(out);
+    suite_pool();
+    suite_arena();
+    suite_vector();
+    suite_llist();
+    suite_end();
+
+    if(path) {
+        fclose(out);
+        printf("wrote container suite to [%s]\n", path);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench_pool_get();
+    bench_pool_churn();
+    bench_pool_iter();
+    bench_hashmap_vs_scan();
+    bench_alloc_churn();
+    bench_spsc_queue();
+    bench_mpmc_queue();
+    bench_radix_sort();
+
+    // the csv goes wherever the first argument says, or stdout
+    bench_container_suite(argc > 1 ? argv[1] : NULL);
+    return 0;
+}
@@ -2,7 +2,10 @@
 
 in vec2 fs_uvs;
 
-uniform vec4 col;
+layout (std140) uniform draw_block {
+    mat4 model;
+    vec4 col;
+};
 
 out vec4 out_col;
 
@@ -3,11 +3,18 @@
 layout (location = 0) in vec2 vs_position;
 layout (location = 1) in vec2 vs_uvs;
 
-uniform mat4 model_mat;
+layout (std140) uniform pass_block {
+    mat4 proj_view;
+};
+
+layout (std140) uniform draw_block {
+    mat4 model;
+    vec4 col;
+};
 
 out vec2 fs_uvs;
 
 void main(void) {
-    gl_Position = model_mat * vec4(vs_position, 0.0, 1.0);
+    gl_Position = proj_view * model * vec4(vs_position, 0.0, 1.0);
     fs_uvs = vs_uvs;
 }
@@ -1,11 +1,10 @@
 #version 430 core
 
 in vec2 fs_uvs;
-
-uniform vec4 col;
+in vec4 fs_col;
 
 out vec4 out_col;
 
 void main(void) {
-    out_col = col;
+    out_col = fs_col;
 }
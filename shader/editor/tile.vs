@@ -3,11 +3,34 @@
 layout (location = 0) in vec2 vs_position;
 layout (location = 1) in vec2 vs_uvs;
 
-uniform mat4 model_mat;
+layout (std140) uniform pass_block {
+    mat4 proj_view;
+};
+
+struct instance_t {
+    vec3 position;
+    float rotation;
+    vec2 scale;
+    uint layer;
+    vec4 colour;
+    vec4 rect;
+};
+
+layout (std430) readonly buffer instance_block {
+    instance_t instances[];
+};
 
 out vec2 fs_uvs;
+out vec4 fs_col;
 
 void main(void) {
-    gl_Position = model_mat * vec4(vs_position, 0.0, 1.0);
-    fs_uvs = vs_uvs;
+    instance_t instance = instances[gl_InstanceID];
+
+    float r = radians(instance.rotation);
+    vec2 local = vs_position * instance.scale;
+    local = vec2(local.x * cos(r) - local.y * sin(r), local.x * sin(r) + local.y * cos(r));
+
+    gl_Position = proj_view * vec4(instance.position.xy + local, instance.position.z, 1.0);
+    fs_uvs = mix(instance.rect.xy, instance.rect.zw, vs_uvs);
+    fs_col = instance.colour;
 }
@@ -1,8 +1,12 @@
 #ifndef _BASE_H
 #define _BASE_H
 
-#include "glad/glad.h"
-#include <GLFW/glfw3.h>
+// headless builds (benchmarks and such) dont get any of the gl/windowing headers
+// so they can be built without glfw or a gl loader
+#if !defined(BASE_HEADLESS)
+#   include "glad/glad.h"
+#   include <GLFW/glfw3.h>
+#endif
 
 #include "base_ctx.h"
 #include "base_types.h"
@@ -39,6 +39,40 @@
 
 #define SIGN(_x) ((_x)<0?-1:1)
 
+// _align has to be a power of two
+#define ALIGN_UP(_x, _align) (((_x) + ((_align) - 1)) & ~((_align) - 1))
+#define IS_POW2(_x) ((_x) != 0 && ((_x) & ((_x) - 1)) == 0)
+
+#define CACHE_LINE_SIZE (64)
+
+#if COMPILER_MSVC
+#   define THREAD_LOCAL __declspec(thread)
+#else
+#   define THREAD_LOCAL _Thread_local
+#endif
+
+// count trailing zeroes of a 64 bit int, undefined for 0
+#if COMPILER_MSVC
+#   include <intrin.h>
+#   define CTZ64(_x) ((unsigned int) _tzcnt_u64((_x)))
+#else
+#   define CTZ64(_x) ((unsigned int) __builtin_ctzll((_x)))
+#endif
+
+// count leading zeroes of a 64 bit int, undefined for 0
+#if COMPILER_MSVC
+#   define CLZ64(_x) ((unsigned int) _lzcnt_u64((_x)))
+#else
+#   define CLZ64(_x) ((unsigned int) __builtin_clzll((_x)))
+#endif
+
+// count set bits of a 64 bit int
+#if COMPILER_MSVC
+#   define POPCOUNT64(_x) ((unsigned int) __popcnt64((_x)))
+#else
+#   define POPCOUNT64(_x) ((unsigned int) __builtin_popcountll((_x)))
+#endif
+
 #define IN_RANGE(_x, _min, _max) ((_x)>(_min)&&(_x) < (_max))
 #define IN_EPSILON(_x, _e) ((_x)>-(_e)&&(_x)<(_e))
 
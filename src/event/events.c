@@ -5,9 +5,9 @@
 events_ctx_t events_ctx = {0};
 
 void events_init() {
-    arena_t events_rations = arena_new(rations.events);
-    vector_t queue = arena_vector_push(&events_rations, EVENTS_MAX, sizeof(event_t));
-    vector_t observers = arena_vector_push(&events_rations, _EVENT_NUM, sizeof(event_observer_t));
+    arena_t* events_rations = &rations.events;
+    vector_t queue = arena_vector_push(events_rations, EVENTS_MAX, sizeof(event_t));
+    vector_t observers = arena_vector_push(events_rations, _EVENT_NUM, sizeof(event_observer_t));
 
     for(u32 i = 0; i < _EVENT_NUM; i ++) {
         event_observer_t observer = {
@@ -26,7 +26,7 @@ void events_init() {
 }
 
 void events_terminate() {
-    arena_clear(&events_ctx.rations);
+    arena_clear(events_ctx.rations);
 }
 
 void event_invoke(event_info_t info) {
@@ -46,15 +46,17 @@ void event_consume(event_t* event) {
 }
 
 void events_process() {
-    while(events_ctx.queue.size > 0) {
-        event_t* event = vector_get(&events_ctx.queue, 0);
+    // walk the queue in order instead of popping the front, then drop it all at once
+    // callbacks can still invoke new events, those just get appended and handled in this same loop
+    for(u32 i = 0; i < events_ctx.queue.size; i ++) {
+        event_t* event = vector_get(&events_ctx.queue, i);
         event_observer_t* observer = vector_get(&events_ctx.observers, event->type);
         llist_iter_t iter = {0};
         while(event->state == EVENT_STATE_WAITING && llist_iter(&observer->callbacks, &iter)) {
             event_callback_fn clbk = iter.data;
             clbk(event);
         }
-
-        vector_remove(&events_ctx.queue, 0);
     }
+
+    vector_clear(&events_ctx.queue);
 }
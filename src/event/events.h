@@ -50,7 +50,7 @@ typedef struct event_observer_t {
 void event_listen(event_type_t type, event_callback_fn clbk);
 
 typedef struct events_ctx_t {
-    arena_t rations;
+    arena_t* rations;
     vector_t queue;
     vector_t observers;
 } events_ctx_t;
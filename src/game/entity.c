@@ -11,21 +11,23 @@ entity_ctx_t entity_ctx = {0};
 
 void entity_init() {
     // ENTITIES
-    arena_t entity_rations = arena_new(rations.entity);
-    pool_t pool = arena_pool_push(&entity_rations, ENTITY_MAX, sizeof(entity_slot_t));
+    arena_t* entity_rations = &rations.entity;
+    entity_slot_pool_t pool = arena_entity_slot_pool_push(entity_rations, ENTITY_MAX);
 
     entity_manager_t render_manager = {
         .label = "render-manager",
-        .batch = arena_vector_push(&entity_rations, ENTITY_MAX, sizeof(entity_t)),
+        .id = str_intern("render-manager"),
+        .batch = arena_entity_vector_push(entity_rations, ENTITY_MAX),
     };
 
     entity_manager_t player_manager = {
         .label = "player-manager",
-        .batch = arena_vector_push(&entity_rations, 1, sizeof(entity_t)),
+        .id = str_intern("player-manager"),
+        .batch = arena_entity_vector_push(entity_rations, 1),
     };
 
     // reserve first element for invalid ids
-    (void) pool_push(&pool, NULL);
+    (void) entity_slot_pool_push(&pool, NULL);
 
     entity_ctx = (entity_ctx_t) {
         .rations = entity_rations,
@@ -37,12 +39,12 @@ void entity_init() {
 }
 
 void entity_terminate() {
-    arena_clear(&entity_ctx.rations);
+    arena_clear(entity_ctx.rations);
 }
 
 entity_t entity_new(entity_info_t info) {
     entity_t ent = {0};
-    entity_slot_t* slot = pool_push(&entity_ctx.entity_pool, &ent.id);
+    entity_slot_t* slot = entity_slot_pool_push(&entity_ctx.entity_pool, &ent.id);
     mem_clear(slot, sizeof(entity_slot_t));
 
     if(info.transform.scale.x == 0.0f) info.transform.scale.x = 1.0f;
@@ -64,7 +66,7 @@ void entity_destroy(entity_t ent) {
         return;
     }
 
-    pool_free(&entity_ctx.entity_pool, ent.id);
+    entity_slot_pool_free(&entity_ctx.entity_pool, ent.id);
 }
 
 entity_slot_t* entity_get_slot(entity_t ent) {
@@ -73,12 +75,12 @@ entity_slot_t* entity_get_slot(entity_t ent) {
         return NULL;
     }
 
-    return pool_get(&entity_ctx.entity_pool, ent.id);
+    return entity_slot_pool_get(&entity_ctx.entity_pool, ent.id);
 }
 
 // TODO(nix3l): huh??
 entity_slot_state_t entity_get_state(entity_t ent) {
-    entity_slot_t* slot = pool_get(&entity_ctx.entity_pool, ent.id);
+    entity_slot_t* slot = entity_slot_pool_get(&entity_ctx.entity_pool, ent.id);
     if(!slot) {
         LOG_ERR_CODE(ERR_ENT_BAD_SLOT);
         return ENT_STATE_FREE;
@@ -88,7 +90,7 @@ entity_slot_state_t entity_get_state(entity_t ent) {
 }
 
 entity_data_t* entity_get_data(entity_t ent) {
-    entity_slot_t* slot = pool_get(&entity_ctx.entity_pool, ent.id);
+    entity_slot_t* slot = entity_slot_pool_get(&entity_ctx.entity_pool, ent.id);
     if(!slot) {
         LOG_ERR_CODE(ERR_ENT_BAD_SLOT);
         return NULL;
@@ -98,7 +100,7 @@ entity_data_t* entity_get_data(entity_t ent) {
 }
 
 void entity_mark_dirty(entity_t ent) {
-    entity_slot_t* slot = pool_get(&entity_ctx.entity_pool, ent.id);
+    entity_slot_t* slot = entity_slot_pool_get(&entity_ctx.entity_pool, ent.id);
     if(!slot) {
         LOG_ERR_CODE(ERR_ENT_BAD_SLOT);
         return;
@@ -114,7 +116,15 @@ void entity_manager_push(entity_manager_t* manager, entity_t ent) {
         return;
     }
 
-    vector_push_data(&manager->batch, &ent);
+    entity_vector_push(&manager->batch, ent);
+}
+
+entity_manager_t* entity_get_manager(str_id_t id) {
+    for(u32 i = 0; i < entity_ctx.num_managers; i ++) {
+        if(entity_ctx.managers[i].id == id) return &entity_ctx.managers[i];
+    }
+
+    return NULL;
 }
 
 bool entity_manager_iter(entity_manager_t* manager, entity_iter_t* iter) {
@@ -126,7 +136,7 @@ bool entity_manager_iter(entity_manager_t* manager, entity_iter_t* iter) {
     iter->ent.id = ENT_INVALID_ID;
     iter->slot = NULL;
     while(iter->index < manager->batch.size && !iter->slot) {
-        vector_fetch(&manager->batch, iter->index++, &iter->ent);
+        iter->ent = manager->batch.data[iter->index ++];
         iter->slot = entity_get_slot(iter->ent);
         if(!iter->slot) LOG_ERR_CODE(ERR_ENT_BAD_SLOT);
         else return true;
@@ -161,26 +171,22 @@ static void entity_render_update(entity_t ent) {
     });
 }
 
+static bool entity_is_garbage(void* element, void* user_data) {
+    UNUSED(user_data);
+
+    entity_slot_t* slot = entity_get_slot(*(entity_t*) element);
+    if(!slot) return true;
+    return slot->state == ENT_STATE_DIRTY;
+}
+
 static void entity_manager_collect_garbage(entity_manager_t* manager) {
     if(!manager) {
         LOG_ERR_CODE(ERR_ENT_BAD_MANAGER);
         return;
     }
 
-    if(manager->batch.size == 0) return;
-
-    for(u32 i = manager->batch.size - 1; i > 0; i --) {
-        entity_t ent;
-        vector_fetch(&manager->batch, i, &ent);
-
-        bool garbage = false;
-
-        entity_slot_t* slot = entity_get_slot(ent);
-        if(!slot) garbage = true;
-        else if(slot->state == ENT_STATE_DIRTY) garbage = true;
-
-        if(garbage) vector_remove(&manager->batch, i);
-    }
+    // one compaction pass, keeps the batch order
+    vector_remove_if(&manager->batch.base, entity_is_garbage, NULL);
 }
 
 static void entity_collect_garbage() {
@@ -193,11 +199,12 @@ static void entity_collect_garbage() {
     // unless there are way more entities than this engine supports
     // so no need to change this code yet
     u32 num_destroyed = 0;
-    pool_iter_t iter = { .absolute_index = 1 };
-    while(pool_iter(&entity_ctx.entity_pool, &iter)) {
-        entity_slot_t* slot = iter.data;
-        if(slot->state == ENT_STATE_DIRTY) {
-            entity_destroy((entity_t){iter.handle});
+    pool_run_iter_t iter = { .absolute_index = 1 };
+    while(pool_iter_runs(&entity_ctx.entity_pool.base, &iter)) {
+        entity_slot_t* slots = iter.run.data;
+        for(u32 i = 0; i < iter.run.count; i ++) {
+            if(slots[i].state != ENT_STATE_DIRTY) continue;
+            entity_destroy((entity_t){ pool_handle_at_index(&entity_ctx.entity_pool.base, iter.run.start + i) });
             num_destroyed ++;
         }
     }
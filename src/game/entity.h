@@ -4,6 +4,7 @@
 #include "base.h"
 #include "gfx/gfx.h"
 #include "physics/physics.h"
+#include "memory/typed.h"
 
 #define ENT_INVALID_ID (0)
 
@@ -13,6 +14,8 @@ enum {
 
 typedef struct { handle_t id; } entity_t;
 
+VECTOR_DEFINE_NAMED(entity_t, entity)
+
 typedef enum entity_tags_t {
     ENT_TAGS_NONE    = 0x00,
     ENT_TAGS_RENDER  = 0x01,
@@ -57,6 +60,8 @@ typedef struct entity_slot_t {
     entity_data_t data;
 } entity_slot_t;
 
+POOL_DEFINE_NAMED(entity_slot_t, entity_slot)
+
 entity_t entity_new(entity_info_t info);
 void entity_destroy(entity_t ent);
 
@@ -68,10 +73,13 @@ void entity_mark_dirty(entity_t ent);
 
 typedef struct entity_manager_t {
     const char* label;
-    vector_t batch;
+    str_id_t id; // interned label
+    entity_vector_t batch;
 } entity_manager_t;
 
 void entity_manager_push(entity_manager_t* manager, entity_t ent);
+// finds a manager by its label, ie entity_get_manager(STR_ID("render-manager"))
+entity_manager_t* entity_get_manager(str_id_t id);
 
 typedef struct entity_iter_t {
     u32 index;
@@ -82,8 +90,8 @@ typedef struct entity_iter_t {
 bool entity_manager_iter(entity_manager_t* manager, entity_iter_t* iter);
 
 typedef struct entity_ctx_t {
-    arena_t rations;
-    pool_t entity_pool;
+    arena_t* rations;
+    entity_slot_pool_t entity_pool;
     u32 num_dirty_entities;
 
     u32 num_managers;
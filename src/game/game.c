@@ -11,42 +11,58 @@
 
 game_ctx_t game_ctx;
 
-static void construct_uniforms(void* out, draw_call_t* call) {
-    draw_pass_cache_t* cache = render_get_active_cache();
-
-    struct __attribute__((packed)) {
-        mat4 proj_viewModel;
-        vec4 col;
-    } uniforms;
-
-    mat4s proj_viewModel = glms_mat4_mul(cache->proj_view, model_matrix_new(call->position, call->rotation, call->scale));
-    memcpy(uniforms.proj_viewModel, proj_viewModel.raw, sizeof(mat4));
+// std140, matches draw_block in shader/default.vs
+typedef struct draw_uniforms_t {
+    mat4 model;
+    vec4 col;
+} draw_uniforms_t;
 
-    memcpy(uniforms.col, call->colour.raw, sizeof(vec4));
+// writes straight into the mapped draw buffer, proj_view comes from the pass buffer
+static void construct_uniforms(void* out, draw_call_t* call) {
+    draw_uniforms_t* uniforms = out;
 
-    memcpy(out, &uniforms, sizeof(uniforms));
+    mat4s model = model_matrix_new(call->position, call->rotation, call->scale);
+    memcpy(uniforms->model, model.raw, sizeof(mat4));
+    memcpy(uniforms->col, call->colour.raw, sizeof(vec4));
 }
 
 void game_init() {
-    arena_t game_rations = arena_new(rations.game);
+    arena_t* game_rations = &rations.game;
 
-    arena_t code_arena = arena_alloc_new(4096);
-    range_t shader_vs = platform_load_file(&code_arena, "shader/default.vs");
-    range_t shader_fs = platform_load_file(&code_arena, "shader/default.fs");
+    arena_temp_t scratch = scratch_begin(NULL, 0);
+    range_t shader_vs = platform_load_file(scratch.arena, "shader/default.vs");
+    range_t shader_fs = platform_load_file(scratch.arena, "shader/default.fs");
     shader_t shader = shader_new((shader_info_t) {
         .name = "game shader",
         .attribs = {
             { .name = "vs_position" },
             { .name = "vs_uvs" },
         },
-        .uniforms = {
-            { .name = "model_mat", .type = UNIFORM_TYPE_mat4, },
-            { .name = "col", .type = UNIFORM_TYPE_v4f, },
+        .buffers = {
+            {
+                .name = "pass_block",
+                .rate = UNIFORM_BLOCK_RATE_PASS,
+                .bytes = sizeof(draw_pass_uniforms_t),
+                .uniforms = {
+                    { .name = "proj_view", .type = UNIFORM_TYPE_mat4, },
+                },
+            },
+            {
+                .name = "draw_block",
+                .rate = UNIFORM_BLOCK_RATE_DRAW,
+                .bytes = sizeof(draw_uniforms_t),
+                .uniforms = {
+                    { .name = "model", .type = UNIFORM_TYPE_mat4, },
+                    { .name = "col", .type = UNIFORM_TYPE_v4f, },
+                },
+            },
         },
         .vertex_src = shader_vs,
         .fragment_src = shader_fs,
     });
 
+    scratch_end(scratch);
+
     renderer_t renderer = (renderer_t) {
         .label = "entity renderer",
         .num_groups = 1,
@@ -71,7 +87,7 @@ void game_init() {
                         .projection = { .type = PROJECTION_ORTHO, },
                     },
                 },
-                .batch = llist_new(),
+                .batch = clist_new(sizeof(draw_call_t), DRAW_BATCH_CHUNK_SIZE),
                 .construct_uniforms = construct_uniforms,
             },
         },
@@ -96,7 +112,7 @@ void game_init() {
 }
 
 void game_terminate() {
-    arena_clear(&game_ctx.rations);
+    arena_clear(game_ctx.rations);
 }
 
 void game_load_room(room_t room) {
@@ -9,7 +9,7 @@
 #include "room.h"
 
 typedef struct {
-    arena_t rations;
+    arena_t* rations;
 
     entity_t player;
     camera_t camera;
@@ -19,8 +19,12 @@ gfx_ctx_t gfx_ctx;
 #define BACKEND_FUNCS_LIST \
     BACKEND_FUNC_XMACRO(mesh_init, mesh_t mesh, mesh_info_t info) \
     BACKEND_FUNC_XMACRO(mesh_destroy, mesh_t mesh) \
+    BACKEND_FUNC_XMACRO(mesh_update_range, mesh_t mesh, u32 attribute, u32 offset, range_t data) \
+    BACKEND_FUNC_XMACRO(mesh_update_indices, mesh_t mesh, range_t data) \
     BACKEND_FUNC_XMACRO(texture_init, texture_t texture, texture_info_t info) \
     BACKEND_FUNC_XMACRO(texture_destroy, texture_t texture) \
+    BACKEND_FUNC_XMACRO(texture_update, texture_t texture, texture_region_t region, range_t data) \
+    BACKEND_FUNC_XMACRO(texture_generate_mipmaps, texture_t texture) \
     BACKEND_FUNC_XMACRO(sampler_init, sampler_t sampler, sampler_info_t info) \
     BACKEND_FUNC_XMACRO(sampler_destroy, sampler_t sampler) \
     BACKEND_FUNC_XMACRO(attachments_init, attachments_t att, attachments_info_t info) \
@@ -28,11 +32,16 @@ gfx_ctx_t gfx_ctx;
     BACKEND_FUNC_XMACRO(shader_init, shader_t shader, shader_info_t info) \
     BACKEND_FUNC_XMACRO(shader_destroy, shader_t shader) \
     BACKEND_FUNC_XMACRO(shader_update_uniforms, shader_t shader, range_t uniforms) \
+    BACKEND_FUNC_XMACRO(shader_map_uniform_buffer, shader_t shader, u32 buffer, u32 count, void** out) \
+    BACKEND_FUNC_XMACRO(shader_unmap_uniform_buffer, shader_t shader, u32 buffer) \
+    BACKEND_FUNC_XMACRO(shader_bind_uniform_buffer, shader_t shader, u32 buffer, u32 copy) \
     BACKEND_FUNC_XMACRO(activate_pipeline, render_pipeline_t pipeline) \
     BACKEND_FUNC_XMACRO(clear_pipeline, void) \
     BACKEND_FUNC_XMACRO(activate_bindings, render_bindings_t bindings) \
     BACKEND_FUNC_XMACRO(draw, mesh_t mesh) \
+    BACKEND_FUNC_XMACRO(draw_instanced, mesh_t mesh, u32 instances) \
     BACKEND_FUNC_XMACRO(viewport, viewport_t view) \
+    BACKEND_FUNC_XMACRO(end_frame, void) \
 
 #define BACKEND_FUNC_XMACRO(_name, ...) typedef void (*_name ## _func) (__VA_ARGS__);
 BACKEND_FUNCS_LIST;
@@ -73,6 +82,14 @@ typedef struct gl_mesh_internal_t {
     u32 vao;
     u32 vbos[GFX_MAX_VERTEX_ATTRIBS];
     u32 index_vbo;
+
+    // stream meshes only
+    bool streamed;
+    void* mapped[GFX_MAX_VERTEX_ATTRIBS];
+    void* mapped_indices;
+    u32 region; // which of the GFX_STREAM_FRAMES copies is current
+    u64 written_frame;
+    u64 region_frame[GFX_STREAM_FRAMES]; // last frame each copy was drawn in
 } gl_mesh_internal_t;
 
 typedef struct gl_texture_internal_t {
@@ -89,6 +106,9 @@ typedef struct gl_attachments_internal_t {
 
 typedef struct gl_shader_internal_t {
     u32 program;
+    u32 ubos[GFX_MAX_UNIFORM_BLOCKS];
+    u32 ubo_capacity[GFX_MAX_UNIFORM_BLOCKS];
+    u32 ubo_mapped[GFX_MAX_UNIFORM_BLOCKS]; // bytes mapped last time, instance buffers get bound whole
 } gl_shader_internal_t;
 
 // pools
@@ -101,9 +121,9 @@ static gfx_respool_t shader_pool = {0};
 static gfx_respool_t gfx_respool_alloc_new(u32 capacity, u32 res_bytes, u32 internal_bytes) {
     gfx_respool_t pool = (gfx_respool_t) {
         .capacity = capacity,
-        .res_pool = arena_pool_push(&gfx_ctx.rations, capacity, sizeof(gfx_res_slot_t)),
-        .data_pool = arena_pool_push(&gfx_ctx.rations, capacity, res_bytes),
-        .internal_pool = arena_pool_push(&gfx_ctx.rations, capacity, internal_bytes),
+        .res_pool = arena_pool_push(gfx_ctx.rations, capacity, sizeof(gfx_res_slot_t)),
+        .data_pool = arena_pool_push(gfx_ctx.rations, capacity, res_bytes),
+        .internal_pool = arena_pool_push(gfx_ctx.rations, capacity, internal_bytes),
     };
 
     // reserve the 0 index for invalid ids
@@ -114,6 +134,14 @@ static gfx_respool_t gfx_respool_alloc_new(u32 capacity, u32 res_bytes, u32 inte
     return pool;
 }
 
+// copies the range into the gfx rations so it lives as long as the context does
+static range_t gfx_copy_range(range_t range) {
+    if(!range.ptr || !range.size) return range;
+    range_t copy = arena_range_push(gfx_ctx.rations, range.size);
+    memcpy(copy.ptr, range.ptr, range.size);
+    return copy;
+}
+
 static gfx_res_slot_t* gfx_respool_alloc_slot(gfx_respool_t* pool, handle_t* id) {
     if(!pool) return NULL;
     gfx_res_slot_t* slot = pool_push(&pool->res_pool, id);
@@ -166,7 +194,7 @@ void gfx_init(gfx_backend_t backend) {
     };
 
     gfx_ctx = (gfx_ctx_t) {
-        .rations = arena_new(rations.gfx),
+        .rations = &rations.gfx,
         .backend = backend,
         .backend_info = {
             (gfx_backend_info_t) {0},
@@ -193,10 +221,12 @@ void gfx_init(gfx_backend_t backend) {
     gfx_ctx.shader_pool = &shader_pool;
 
     init_jumptables();
+    // nothing is known about the fresh context yet
+    backend_jumptables[backend].end_frame();
 }
 
 void gfx_terminate() {
-    arena_clear(&gfx_ctx.rations);
+    arena_clear(gfx_ctx.rations);
 }
 
 gfx_backend_t gfx_backend() {
@@ -260,12 +290,38 @@ void mesh_init(mesh_t mesh, mesh_info_t info) {
     if(info.winding == MESH_WINDING_UNDEFINED)
         info.winding = MESH_WINDING_CCW;
 
+    if(info.usage == MESH_USAGE_UNDEFINED)
+        info.usage = MESH_USAGE_STATIC;
+
+    mesh_attribute_t first = info.attributes[0];
+    u32 vertex_capacity = first.dimensions ? first.data.size / (first.dimensions * sizeof(f32)) : 0;
+
+    // every copy of a stream mesh is drawn with a base vertex, so the attributes have to line up
+    // if they dont the copies would read each other's vertices, so it gets plain buffer updates instead
+    if(info.usage == MESH_USAGE_STREAM) {
+        for(u32 i = 0; i < mesh_format_num_attributes(info.format); i ++) {
+            mesh_attribute_t attribute = info.attributes[i];
+            if(attribute.data.size == vertex_capacity * attribute.dimensions * sizeof(f32)) continue;
+
+            LOG_ERR("attribute [%u] of stream mesh doesnt hold the same number of vertices as attribute [0]. making it dynamic.\n", i);
+            info.usage = MESH_USAGE_DYNAMIC;
+            break;
+        }
+    }
+
     mesh_data->format = info.format;
     mesh_data->index_type = info.index_type;
     mesh_data->primitive = info.primitive;
     mesh_data->winding = info.winding;
+    mesh_data->usage = info.usage;
     mesh_data->count = info.count;
 
+    mesh_data->vertex_capacity = vertex_capacity;
+    mesh_data->index_capacity = info.indices.size;
+
+    for(u32 i = 0; i < mesh_format_num_attributes(info.format); i ++)
+        mesh_data->attribute_capacity[i] = info.attributes[i].data.size;
+
     pool_push(&gfx_ctx.mesh_pool->internal_pool, &slot->internal_handle);
     backend->mesh_init(mesh, info);
     slot->state = GFX_RES_STATE_INIT;
@@ -324,6 +380,99 @@ static void* mesh_get_internal(mesh_t mesh) {
     return pool_get(&gfx_ctx.mesh_pool->internal_pool, slot->internal_handle);
 }
 
+// returns false if the write got rejected
+static bool mesh_write_range(mesh_t mesh, mesh_data_t* mesh_data, u32 attribute, u32 offset, range_t data) {
+    if(attribute >= mesh_format_num_attributes(mesh_data->format)) {
+        LOG_ERR("mesh doesnt have an attribute [%u]. ignoring.\n", attribute);
+        return false;
+    }
+
+    if(offset + data.size > mesh_data->attribute_capacity[attribute]) {
+        LOG_ERR("update of [%zu] bytes at [%u] doesnt fit in attribute [%u]. ignoring.\n", data.size, offset, attribute);
+        return false;
+    }
+
+    backend->mesh_update_range(mesh, attribute, offset, data);
+    return true;
+}
+
+void mesh_update(mesh_t mesh, mesh_update_t update) {
+    mesh_data_t* mesh_data = mesh_get_data(mesh);
+    if(!mesh_data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return;
+    }
+
+    if(mesh_data->usage == MESH_USAGE_STATIC) {
+        LOG_ERR("tried to update a static mesh. ignoring.\n");
+        return;
+    }
+
+    // a stream update lands in a fresh copy, anything left out would be read from a stale one
+    if(mesh_data->usage == MESH_USAGE_STREAM) {
+        // checked up front too, so a bad update cant leave the new copy half written
+        bool complete = mesh_data->index_type == MESH_INDEX_NONE ||
+                        (update.indices.size > 0 && update.indices.size <= mesh_data->index_capacity);
+        for(u32 i = 0; i < mesh_format_num_attributes(mesh_data->format); i ++)
+            complete &= update.attributes[i].size > 0 && update.attributes[i].size <= mesh_data->attribute_capacity[i];
+
+        if(!complete) {
+            LOG_ERR("stream mesh updates have to write every attribute and the indices within capacity. ignoring.\n");
+            return;
+        }
+    }
+
+    bool rejected = false;
+    for(u32 i = 0; i < mesh_format_num_attributes(mesh_data->format); i ++) {
+        if(update.attributes[i].size == 0) continue;
+        rejected |= !mesh_write_range(mesh, mesh_data, i, 0, update.attributes[i]);
+    }
+
+    if(update.indices.size > 0) {
+        if(mesh_data->index_type == MESH_INDEX_NONE || update.indices.size > mesh_data->index_capacity) {
+            LOG_ERR("mesh indices dont fit. ignoring.\n");
+            rejected = true;
+        } else {
+            backend->mesh_update_indices(mesh, update.indices);
+        }
+    }
+
+    // the count has to describe whats actually in the buffers
+    if(update.count == 0) return;
+    if(rejected) {
+        LOG_ERR("part of the mesh update got rejected, keeping the old count [%u].\n", mesh_data->count);
+        return;
+    }
+
+    u32 max_count = mesh_data->index_type == MESH_INDEX_NONE ? mesh_data->vertex_capacity : mesh_data->index_capacity / sizeof(u32);
+    if(update.count > max_count) {
+        LOG_ERR("mesh count [%u] is over its capacity [%u]. clamping.\n", update.count, max_count);
+        update.count = max_count;
+    }
+
+    mesh_data->count = update.count;
+}
+
+void mesh_update_range(mesh_t mesh, u32 attribute, u32 offset, range_t data) {
+    mesh_data_t* mesh_data = mesh_get_data(mesh);
+    if(!mesh_data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return;
+    }
+
+    if(mesh_data->usage == MESH_USAGE_STATIC) {
+        LOG_ERR("tried to update a static mesh. ignoring.\n");
+        return;
+    }
+
+    if(mesh_data->usage == MESH_USAGE_STREAM) {
+        LOG_ERR("stream meshes can only be rewritten whole with mesh_update. ignoring.\n");
+        return;
+    }
+
+    mesh_write_range(mesh, mesh_data, attribute, offset, data);
+}
+
 texture_t texture_alloc() {
     texture_t texture = {0};
     gfx_res_slot_t* slot = gfx_respool_alloc_slot(gfx_ctx.texture_pool, &texture.id);
@@ -333,6 +482,86 @@ texture_t texture_alloc() {
     return texture;
 }
 
+static u32 texture_format_pixel_bytes(texture_format_t format) {
+    switch(format) {
+        case TEXTURE_FORMAT_R8:
+        case TEXTURE_FORMAT_R8I:
+        case TEXTURE_FORMAT_R8UI:
+            return 1;
+        case TEXTURE_FORMAT_R16:
+        case TEXTURE_FORMAT_R16F:
+        case TEXTURE_FORMAT_R16I:
+        case TEXTURE_FORMAT_R16UI:
+        case TEXTURE_FORMAT_RG8:
+        case TEXTURE_FORMAT_RG8I:
+        case TEXTURE_FORMAT_RG8UI:
+            return 2;
+        case TEXTURE_FORMAT_RGB8:
+        case TEXTURE_FORMAT_RGB8I:
+        case TEXTURE_FORMAT_RGB8UI:
+            return 3;
+        case TEXTURE_FORMAT_R32F:
+        case TEXTURE_FORMAT_R32I:
+        case TEXTURE_FORMAT_R32UI:
+        case TEXTURE_FORMAT_RG16:
+        case TEXTURE_FORMAT_RG16F:
+        case TEXTURE_FORMAT_RG16I:
+        case TEXTURE_FORMAT_RG16UI:
+        case TEXTURE_FORMAT_RGBA8:
+        case TEXTURE_FORMAT_RGBA8I:
+        case TEXTURE_FORMAT_RGBA8UI:
+        case TEXTURE_FORMAT_DEPTH:
+        case TEXTURE_FORMAT_DEPTH_STENCIL:
+            return 4;
+        case TEXTURE_FORMAT_RGB16F:
+        case TEXTURE_FORMAT_RGB16I:
+        case TEXTURE_FORMAT_RGB16UI:
+            return 6;
+        case TEXTURE_FORMAT_RG32F:
+        case TEXTURE_FORMAT_RG32I:
+        case TEXTURE_FORMAT_RG32UI:
+        case TEXTURE_FORMAT_RGBA16F:
+        case TEXTURE_FORMAT_RGBA16I:
+        case TEXTURE_FORMAT_RGBA16UI:
+            return 8;
+        case TEXTURE_FORMAT_RGB32F:
+        case TEXTURE_FORMAT_RGB32I:
+        case TEXTURE_FORMAT_RGB32UI:
+            return 12;
+        case TEXTURE_FORMAT_RGBA32F:
+        case TEXTURE_FORMAT_RGBA32I:
+        case TEXTURE_FORMAT_RGBA32UI:
+            return 16;
+        default: UNREACHABLE; return 0;
+    }
+}
+
+// levels it takes to get from w x h down to 1x1
+static u32 texture_full_mip_chain(u32 width, u32 height) {
+    u32 levels = 1;
+    u32 size = MAX(width, height);
+    while(size > 1) {
+        size >>= 1;
+        levels ++;
+    }
+
+    return levels;
+}
+
+static u32 texture_mip_size(u32 size, u32 level) {
+    return MAX(size >> level, 1);
+}
+
+static usize texture_mip_level_bytes(texture_format_t format, u32 width, u32 height, u32 layers, u32 level) {
+    return (usize) texture_mip_size(width, level) * texture_mip_size(height, level) * layers * texture_format_pixel_bytes(format);
+}
+
+static usize texture_mip_chain_bytes(texture_format_t format, u32 width, u32 height, u32 layers, u32 levels) {
+    usize bytes = 0;
+    for(u32 i = 0; i < levels; i ++) bytes += texture_mip_level_bytes(format, width, height, layers, i);
+    return bytes;
+}
+
 void texture_init(texture_t texture, texture_info_t info) {
     gfx_res_slot_t* slot = gfx_respool_get_slot(gfx_ctx.texture_pool, texture.id);
     if(!slot) {
@@ -349,7 +578,20 @@ void texture_init(texture_t texture, texture_info_t info) {
     if(info.type == TEXTURE_TYPE_UNDEFINED) info.type = TEXTURE_TYPE_2D;
     if(info.filter == TEXTURE_FILTER_UNDEFINED) info.filter = TEXTURE_FILTER_NEAREST;
     if(info.wrap == TEXTURE_WRAP_UNDEFINED) info.wrap = TEXTURE_WRAP_CLAMP_TO_EDGE;
-    if(info.mipmaps == 0) info.mipmaps = 1;
+    if(info.layers == 0 || info.type != TEXTURE_TYPE_2D_ARRAY) info.layers = 1;
+
+    u32 full_chain = texture_full_mip_chain(info.width, info.height);
+    if(info.mips == TEXTURE_MIPS_NONE) info.mipmaps = 1;
+    else if(info.mipmaps == 0 || info.mipmaps > full_chain) info.mipmaps = full_chain;
+
+    if(info.mips == TEXTURE_MIPS_SUPPLIED && info.data.ptr) {
+        usize expected = texture_mip_chain_bytes(info.format, info.width, info.height, info.layers, info.mipmaps);
+        if(info.data.size != 0 && info.data.size < expected) {
+            LOG_ERR("supplied mip chain is [%zu] bytes, expected [%zu]. only keeping the base level.\n", info.data.size, expected);
+            info.mips = TEXTURE_MIPS_NONE;
+            info.mipmaps = 1;
+        }
+    }
 
     texture_data->type = info.type;
     texture_data->format = info.format;
@@ -357,7 +599,9 @@ void texture_init(texture_t texture, texture_info_t info) {
     texture_data->filter = info.filter;
     texture_data->width = info.width;
     texture_data->height = info.height;
+    texture_data->layers = info.layers;
     texture_data->mipmaps = info.mipmaps;
+    texture_data->mips = info.mips;
 
     pool_push(&gfx_ctx.texture_pool->internal_pool, &slot->internal_handle);
     backend->texture_init(texture, info);
@@ -418,6 +662,52 @@ static void* texture_get_internal(texture_t texture) {
     return pool_get(&gfx_ctx.texture_pool->internal_pool, slot->internal_handle);
 }
 
+void texture_generate_mipmaps(texture_t texture) {
+    texture_data_t* texture_data = texture_get_data(texture);
+    if(!texture_data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return;
+    }
+
+    if(texture_data->mipmaps <= 1) return;
+    backend->texture_generate_mipmaps(texture);
+}
+
+void texture_upload_layer(texture_t texture, u32 layer, range_t data) {
+    texture_data_t* texture_data = texture_get_data(texture);
+    if(!texture_data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return;
+    }
+
+    texture_update_region(texture, (texture_region_t) {
+        .layer = layer,
+        .w = texture_data->width,
+        .h = texture_data->height,
+    }, data);
+}
+
+void texture_update_region(texture_t texture, texture_region_t region, range_t data) {
+    texture_data_t* texture_data = texture_get_data(texture);
+    if(!texture_data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return;
+    }
+
+    if(region.layer >= texture_data->layers) {
+        LOG_ERR("texture only has [%u] layers, cant update layer [%u]. ignoring.\n", texture_data->layers, region.layer);
+        return;
+    }
+
+    if(region.x + region.w > texture_data->width || region.y + region.h > texture_data->height) {
+        LOG_ERR("region [%u, %u] to [%u, %u] is outside the texture. ignoring.\n", region.x, region.y, region.x + region.w, region.y + region.h);
+        return;
+    }
+
+    if(!data.ptr || region.w == 0 || region.h == 0) return;
+    backend->texture_update(texture, region, data);
+}
+
 sampler_t sampler_alloc() {
     sampler_t sampler = {0};
     gfx_res_slot_t* slot = gfx_respool_alloc_slot(gfx_ctx.sampler_pool, &sampler.id);
@@ -454,6 +744,11 @@ void sampler_init(sampler_t sampler, sampler_info_t info) {
     sampler_data->v_wrap = info.v_wrap;
     sampler_data->min_filter = info.min_filter;
     sampler_data->mag_filter = info.mag_filter;
+    sampler_data->mip_filter = info.mip_filter;
+    sampler_data->lod_bias = info.lod_bias;
+    sampler_data->clamp_lod = info.clamp_lod;
+    sampler_data->min_lod = info.min_lod;
+    sampler_data->max_lod = info.max_lod;
 
     pool_push(&gfx_ctx.sampler_pool->internal_pool, &slot->internal_handle);
     backend->sampler_init(sampler, info);
@@ -615,6 +910,45 @@ static u32 uniform_type_get_bytes(uniform_type_t type) {
     }
 }
 
+// std140 base alignment, vec3s get aligned like vec4s
+static u32 uniform_type_std140_align(uniform_type_t type) {
+    switch (type) {
+        case UNIFORM_TYPE_i32: return 4;
+        case UNIFORM_TYPE_u32: return 4;
+        case UNIFORM_TYPE_f32: return 4;
+        case UNIFORM_TYPE_v2f: return 8;
+        case UNIFORM_TYPE_v2i: return 8;
+        case UNIFORM_TYPE_v3f: return 16;
+        case UNIFORM_TYPE_v3i: return 16;
+        case UNIFORM_TYPE_v4f: return 16;
+        case UNIFORM_TYPE_v4i: return 16;
+        case UNIFORM_TYPE_mat4: return 16;
+        default: UNREACHABLE; return 0;
+    }
+}
+
+// fills in the std140 offsets of the buffer's uniforms and returns the size of the whole block
+// instance buffers are std430 arrays of structs, where member offsets come out the same but the
+// struct only gets padded to its largest member alignment instead of a whole vec4
+static u32 uniform_buffer_std140_layout(uniform_buffer_t* buffer) {
+    u32 offset = 0;
+    u32 max_align = 4;
+    for(u32 i = 0; i < buffer->num; i ++) {
+        uniform_t* uniform = &buffer->uniforms[i];
+        u32 align = uniform_type_std140_align(uniform->type);
+        max_align = MAX(max_align, align);
+
+        offset = ALIGN_UP(offset, align);
+        uniform->offset = offset;
+        offset += uniform_type_get_bytes(uniform->type);
+    }
+
+    if(buffer->rate == UNIFORM_BLOCK_RATE_INSTANCE) return ALIGN_UP(offset, max_align);
+
+    // blocks are padded out to a multiple of a vec4
+    return ALIGN_UP(offset, 16);
+}
+
 static char* shader_type_name(shader_pass_type_t type) {
     switch(type) {
         case SHADER_PASS_VERTEX: return "vertex";
@@ -647,9 +981,14 @@ void shader_init(shader_t shader, shader_info_t info) {
     }
 
     shader_data->name = info.name;
+    shader_data->id = str_intern(info.name);
 
     memcpy(shader_data->attribs, info.attribs, sizeof(shader_data->attribs));
 
+    // keep our own copy of the sources, callers are free to load them into temporary memory
+    info.vertex_src = gfx_copy_range(info.vertex_src);
+    info.fragment_src = gfx_copy_range(info.fragment_src);
+
     shader_data->vertex_pass = (shader_pass_t) {
         .src = info.vertex_src,
         .type = SHADER_PASS_VERTEX
@@ -660,9 +999,48 @@ void shader_init(shader_t shader, shader_info_t info) {
         .type = SHADER_PASS_FRAGMENT
     };
 
+    shader_data->num_buffers = 0;
+    for(u32 i = 0; i < GFX_MAX_UNIFORM_BLOCKS; i ++) {
+        uniform_buffer_info_t buffer_info = info.buffers[i];
+        if(!buffer_info.name || buffer_info.rate == UNIFORM_BLOCK_RATE_INVALID) break;
+
+        uniform_buffer_t* buffer = &shader_data->buffers[i];
+        *buffer = (uniform_buffer_t) {
+            .name = buffer_info.name,
+            .id = str_intern(buffer_info.name),
+            .index = i,
+            .rate = buffer_info.rate,
+        };
+
+        for(u32 j = 0; j < GFX_MAX_BLOCK_UNIFORMS; j ++) {
+            uniform_t uniform = buffer_info.uniforms[j];
+            if(!uniform.name || uniform.type == UNIFORM_TYPE_INVALID) break;
+
+            buffer->uniforms[j] = (uniform_t) {
+                .name = uniform.name,
+                .id = str_intern(uniform.name),
+                .type = uniform.type,
+            };
+
+            buffer->num ++;
+        }
+
+        buffer->bytes = uniform_buffer_std140_layout(buffer);
+        if(buffer->bytes != buffer_info.bytes)
+            LOG_ERR("uniform buffer [%s] in shader [%s] is [%u] bytes under std140 but its struct is [%u] bytes\n",
+                    buffer->name, info.name, buffer->bytes, buffer_info.bytes);
+
+        shader_data->num_buffers ++;
+    }
+
     pool_push(&gfx_ctx.shader_pool->internal_pool, &slot->internal_handle);
     backend->shader_init(shader, info);
 
+    for(u32 i = 0; i < shader_data->uniform_block.num; i ++) {
+        uniform_t* uniform = &shader_data->uniform_block.uniforms[i];
+        uniform->id = str_intern(uniform->name);
+    }
+
     slot->state = GFX_RES_STATE_INIT;
 }
 
@@ -729,10 +1107,65 @@ u32 shader_get_uniforms_size(shader_t shader) {
     return data->uniform_block.bytes;
 }
 
+uniform_t* shader_get_uniform(shader_t shader, str_id_t name) {
+    shader_data_t* data = shader_get_data(shader);
+    if(!data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return NULL;
+    }
+
+    for(u32 i = 0; i < data->uniform_block.num; i ++) {
+        if(data->uniform_block.uniforms[i].id == name) return &data->uniform_block.uniforms[i];
+    }
+
+    return NULL;
+}
+
 void shader_update_uniforms(shader_t shader, range_t data) {
     backend->shader_update_uniforms(shader, data);
 }
 
+uniform_buffer_t* shader_get_uniform_buffer(shader_t shader, uniform_block_rate_t rate) {
+    shader_data_t* data = shader_get_data(shader);
+    if(!data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return NULL;
+    }
+
+    for(u32 i = 0; i < data->num_buffers; i ++) {
+        if(data->buffers[i].rate == rate) return &data->buffers[i];
+    }
+
+    return NULL;
+}
+
+void* shader_map_uniform_buffer(shader_t shader, u32 buffer, u32 count) {
+    shader_data_t* data = shader_get_data(shader);
+    if(!data) {
+        LOG_ERR_CODE(ERR_GFX_BAD_ID);
+        return NULL;
+    }
+
+    if(buffer >= data->num_buffers) {
+        LOG_ERR("shader [%s] doesnt have a uniform buffer [%u]\n", data->name, buffer);
+        return NULL;
+    }
+
+    if(count == 0) return NULL;
+
+    void* out = NULL;
+    backend->shader_map_uniform_buffer(shader, buffer, count, &out);
+    return out;
+}
+
+void shader_unmap_uniform_buffer(shader_t shader, u32 buffer) {
+    backend->shader_unmap_uniform_buffer(shader, buffer);
+}
+
+void shader_bind_uniform_buffer(shader_t shader, u32 buffer, u32 copy) {
+    backend->shader_bind_uniform_buffer(shader, buffer, copy);
+}
+
 void gfx_activate_pipeline(render_pipeline_t pip) {
     if(pip.depth.func == DEPTH_FUNC_UNDEFINED) pip.depth.func = DEPTH_FUNC_LESS;
     if(pip.cull.face == CULL_FACE_UNDEFINED) pip.cull.face = CULL_FACE_BACK;
@@ -753,11 +1186,167 @@ void gfx_draw() {
     backend->draw(gfx_ctx.active_bindings.mesh);
 }
 
+void gfx_draw_instanced(u32 instances) {
+    if(instances == 0) return;
+    backend->draw_instanced(gfx_ctx.active_bindings.mesh, instances);
+}
+
 void gfx_viewport(viewport_t view) {
     backend->viewport(view);
 }
 
+void gfx_end_frame() {
+    gfx_ctx.last_state_stats = gfx_ctx.state_stats;
+    gfx_ctx.state_stats = (gfx_state_stats_t) {0};
+    backend->end_frame();
+}
+
+gfx_state_stats_t gfx_state_stats() {
+    return gfx_ctx.last_state_stats;
+}
+
 // OPENGL-SPECIFIC
+// STATE CACHE
+// shadow copy of whatever gl state the backend touches, so re-binding something thats
+// already bound never reaches the driver. GL_STATE_UNKNOWN means we dont know whats bound
+// (start of the frame, or someone else has had the context) and the next set always goes through
+#define GL_STATE_UNKNOWN (0xffffffff)
+
+typedef struct gl_buffer_range_t {
+    u32 buffer;
+    u32 offset;
+    u32 bytes;
+} gl_buffer_range_t;
+
+typedef struct gl_state_t {
+    u32 depth_test;
+    u32 depth_func;
+    u32 cull_face;
+    u32 cull_mode;
+    u32 blend;
+    u32 blend_src, blend_dst;
+
+    u32 framebuffer;
+    u32 draw_buffer; // belongs to the bound framebuffer, forgotten whenever that changes
+    u32 program;
+    u32 vao;
+
+    u32 active_texture;
+    u32 texture_targets[GFX_MAX_SAMPLER_SLOTS];
+    u32 textures[GFX_MAX_SAMPLER_SLOTS];
+    u32 samplers[GFX_MAX_SAMPLER_SLOTS];
+
+    gl_buffer_range_t uniform_buffers[GFX_MAX_UNIFORM_BLOCKS];
+    gl_buffer_range_t storage_buffers[GFX_MAX_UNIFORM_BLOCKS];
+
+    viewport_t viewport;
+} gl_state_t;
+
+static gl_state_t gl_state;
+
+static void gl_state_invalidate() {
+    memset(&gl_state, 0xff, sizeof(gl_state_t));
+}
+
+// returns whether the call has to go through, and counts it either way
+static bool gl_state_update(u32* cached, u32 value) {
+    if(*cached == value) {
+        gfx_ctx.state_stats.skipped ++;
+        return false;
+    }
+
+    *cached = value;
+    gfx_ctx.state_stats.issued ++;
+    return true;
+}
+
+static void gl_set_enabled(u32 cap, u32* cached, bool enable) {
+    if(!gl_state_update(cached, enable)) return;
+    if(enable) glEnable(cap);
+    else glDisable(cap);
+}
+
+static void gl_bind_framebuffer(u32 fbo) {
+    if(!gl_state_update(&gl_state.framebuffer, fbo)) return;
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl_state.draw_buffer = GL_STATE_UNKNOWN;
+}
+
+static void gl_draw_buffer(u32 buffer) {
+    if(gl_state_update(&gl_state.draw_buffer, buffer)) glDrawBuffer(buffer);
+}
+
+static void gl_use_program(u32 program) {
+    if(gl_state_update(&gl_state.program, program)) glUseProgram(program);
+}
+
+static void gl_bind_vertex_array(u32 vao) {
+    if(gl_state_update(&gl_state.vao, vao)) glBindVertexArray(vao);
+}
+
+static void gl_active_texture(u32 unit) {
+    if(gl_state_update(&gl_state.active_texture, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+static void gl_bind_texture(u32 unit, u32 target, u32 id) {
+    // binding the same id to a different target on the same unit is a different binding
+    if(gl_state.texture_targets[unit] == target && gl_state.textures[unit] == id) {
+        gfx_ctx.state_stats.skipped ++;
+        return;
+    }
+
+    gl_active_texture(unit);
+    glBindTexture(target, id);
+    gl_state.texture_targets[unit] = target;
+    gl_state.textures[unit] = id;
+    gfx_ctx.state_stats.issued ++;
+}
+
+static void gl_bind_sampler(u32 unit, u32 id) {
+    if(gl_state_update(&gl_state.samplers[unit], id)) glBindSampler(unit, id);
+}
+
+// target is either GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER, they have separate binding points
+static void gl_bind_buffer_range(u32 target, u32 index, u32 buffer, u32 offset, u32 bytes) {
+    gl_buffer_range_t* cached = target == GL_UNIFORM_BUFFER ? &gl_state.uniform_buffers[index] : &gl_state.storage_buffers[index];
+    if(cached->buffer == buffer && cached->offset == offset && cached->bytes == bytes) {
+        gfx_ctx.state_stats.skipped ++;
+        return;
+    }
+
+    glBindBufferRange(target, index, buffer, offset, bytes);
+    *cached = (gl_buffer_range_t) { .buffer = buffer, .offset = offset, .bytes = bytes, };
+    gfx_ctx.state_stats.issued ++;
+}
+
+// gl unbinds deleted objects from the context by itself, so the cache has to follow
+// or a recycled id would look like its still bound
+static void gl_state_forget_texture(u32 id) {
+    for(u32 i = 0; i < GFX_MAX_SAMPLER_SLOTS; i ++)
+        if(gl_state.textures[i] == id) gl_state.textures[i] = 0;
+}
+
+static void gl_state_forget_sampler(u32 id) {
+    for(u32 i = 0; i < GFX_MAX_SAMPLER_SLOTS; i ++)
+        if(gl_state.samplers[i] == id) gl_state.samplers[i] = 0;
+}
+
+static void gl_state_forget_uniform_buffer(u32 id) {
+    for(u32 i = 0; i < GFX_MAX_UNIFORM_BLOCKS; i ++) {
+        if(gl_state.uniform_buffers[i].buffer == id) gl_state.uniform_buffers[i].buffer = 0;
+        if(gl_state.storage_buffers[i].buffer == id) gl_state.storage_buffers[i].buffer = 0;
+    }
+}
+
+static void gl_stream_end_frame();
+
+static void gl_end_frame(void) {
+    gl_stream_end_frame();
+
+    // anything outside the backend (imgui) is free to touch the context in between frames
+    gl_state_invalidate();
+}
+
 // MESH
 static u32 gl_mesh_primitive(mesh_primitive_t primitive) {
     switch(primitive) {
@@ -768,67 +1357,184 @@ static u32 gl_mesh_primitive(mesh_primitive_t primitive) {
     }
 }
 
-static u32 gl_vbo_create(u32 attribute, u32 dimensions, void* data, u32 bytes) {
-    u32 vbo;
-    glGenBuffers(1, &vbo);
+static u32 gl_mesh_usage(mesh_usage_t usage) {
+    switch(usage) {
+        case MESH_USAGE_STATIC: return GL_STATIC_DRAW;
+        case MESH_USAGE_DYNAMIC: return GL_DYNAMIC_DRAW;
+        case MESH_USAGE_STREAM: return GL_STREAM_DRAW;
+        default: UNREACHABLE; return 0;
+    }
+}
+
+// STREAMING
+// stream meshes sit in persistently mapped buffers holding GFX_STREAM_FRAMES copies of the mesh
+// every frame gets a fence, and a copy only gets rewritten once the last frame that drew from it is done
+// so the cpu can be writing frame N+2 while the gpu is still on frame N
+#define GL_STREAM_NEVER (MAX_u64)
+#define GL_STREAM_WAIT_NS (1000000)
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+static struct {
+    u64 frame;
+    GLsync fences[GFX_STREAM_FRAMES]; // fence of frame f lives at f % GFX_STREAM_FRAMES
+} gl_stream = {0};
 
-    glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_STATIC_DRAW);
-    glVertexAttribPointer(attribute, dimensions, GL_FLOAT, GL_FALSE, 0, NULL);
+static bool gl_stream_supported() {
+    // glBufferStorage is 4.4, we only ask for 4.3 so this depends on what the driver hands back
+    // NOTE(nix3l): also false before glad is loaded, which keeps gfx_init from touching gl
+    return GLAD_GL_VERSION_4_4;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    return vbo;
+static void gl_stream_wait(u64 frame) {
+    GLsync fence = gl_stream.fences[frame % GFX_STREAM_FRAMES];
+    if(!fence) return;
+
+    // the first wait has to flush or the fence might never actually reach the gpu
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while(true) {
+        GLenum result = glClientWaitSync(fence, flags, GL_STREAM_WAIT_NS);
+        if(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) return;
+        if(result == GL_WAIT_FAILED) {
+            LOG_ERR("waiting on stream fence for frame [%u] failed\n", (u32) frame);
+            return;
+        }
+
+        flags = 0;
+    }
+}
+
+static void gl_stream_end_frame() {
+    if(!gl_stream_supported()) return;
+
+    // the frame losing its fence here has to be finished first. that way anything older than
+    // the fences we still hold is always done, and only the last GFX_STREAM_FRAMES frames need checking
+    u32 slot = gl_stream.frame % GFX_STREAM_FRAMES;
+    if(gl_stream.fences[slot]) {
+        gl_stream_wait(gl_stream.frame - GFX_STREAM_FRAMES);
+        glDeleteSync(gl_stream.fences[slot]);
+    }
+
+    gl_stream.fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    gl_stream.frame ++;
+}
+
+// moves the mesh onto its next copy the first time its written to in a frame
+static void gl_mesh_stream_advance(gl_mesh_internal_t* glmesh) {
+    if(glmesh->written_frame == gl_stream.frame) return;
+
+    u32 next = (glmesh->region + 1) % GFX_STREAM_FRAMES;
+    u64 last_drawn = glmesh->region_frame[next];
+    if(last_drawn != GL_STREAM_NEVER && last_drawn + GFX_STREAM_FRAMES >= gl_stream.frame)
+        gl_stream_wait(last_drawn);
+
+    glmesh->region = next;
+    glmesh->written_frame = gl_stream.frame;
 }
 
-static u32 gl_indices_vbo_create(u32* indices, u32 bytes) {
-    u32 vbo;
-    glGenBuffers(1, &vbo);
+// creates a buffer for a mesh. streamed buffers get GFX_STREAM_FRAMES copies and stay mapped,
+// with the initial data going into every copy so none of them start out as garbage
+static u32 gl_mesh_buffer_create(u32 target, void* data, u32 bytes, mesh_usage_t usage, bool streamed, void** mapped) {
+    u32 buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+
+    if(!streamed) {
+        glBufferData(target, bytes, data, gl_mesh_usage(usage));
+        return buffer;
+    }
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(target, bytes * GFX_STREAM_FRAMES, NULL, flags);
+    *mapped = glMapBufferRange(target, 0, bytes * GFX_STREAM_FRAMES, flags);
+    if(!*mapped) PANIC("failed to map stream mesh buffer\n");
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, bytes, indices, GL_STATIC_DRAW);
+    if(data) {
+        for(u32 i = 0; i < GFX_STREAM_FRAMES; i ++)
+            memcpy(*mapped + i * bytes, data, bytes);
+    }
 
-    return vbo;
+    return buffer;
 }
 
 static void gl_mesh_init(mesh_t mesh, mesh_info_t info) {
     gl_mesh_internal_t* glmesh = mesh_get_internal(mesh);
     mem_clear(glmesh, sizeof(gl_mesh_internal_t));
 
+    if(info.usage == MESH_USAGE_STREAM) {
+        glmesh->streamed = gl_stream_supported();
+        if(!glmesh->streamed) LOG_WARN("no persistent mapping on this driver, stream mesh falls back to buffer updates\n");
+    }
+
+    glmesh->written_frame = gl_stream.frame;
+    for(u32 i = 0; i < GFX_STREAM_FRAMES; i ++)
+        glmesh->region_frame[i] = GL_STREAM_NEVER;
+
     glGenVertexArrays(1, &glmesh->vao);
-    glBindVertexArray(glmesh->vao);
+    gl_bind_vertex_array(glmesh->vao);
 
+    // enabled attributes are part of the vao, so this only ever has to happen once
     for(u32 i = 0; i < mesh_format_num_attributes(info.format); i ++) {
         mesh_attribute_t attribute = info.attributes[i];
-        glmesh->vbos[i] = gl_vbo_create(i, attribute.dimensions, attribute.data.ptr, attribute.data.size);
+        glmesh->vbos[i] = gl_mesh_buffer_create(GL_ARRAY_BUFFER, attribute.data.ptr, attribute.data.size,
+                                                info.usage, glmesh->streamed, &glmesh->mapped[i]);
+        glVertexAttribPointer(i, attribute.dimensions, GL_FLOAT, GL_FALSE, 0, NULL);
+        glEnableVertexAttribArray(i);
     }
 
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // the element buffer binding is part of the vao, so it stays bound
     if(info.index_type != MESH_INDEX_NONE)
-        glmesh->index_vbo = gl_indices_vbo_create(info.indices.ptr, info.indices.size);
+        glmesh->index_vbo = gl_mesh_buffer_create(GL_ELEMENT_ARRAY_BUFFER, info.indices.ptr, info.indices.size,
+                                                  info.usage, glmesh->streamed, &glmesh->mapped_indices);
 
-    glBindVertexArray(0);
+    gl_bind_vertex_array(0);
 }
 
 static void gl_mesh_destroy(mesh_t mesh) {
     gl_mesh_internal_t* glmesh = mesh_get_internal(mesh);
 
     // glDeleteBuffers simply ignores any 0's or invalid ids
-    // so this is perfectly fine
+    // so this is perfectly fine. persistent mappings go with the buffers
     glDeleteBuffers(GFX_MAX_VERTEX_ATTRIBS, glmesh->vbos);
     glDeleteBuffers(1, &glmesh->index_vbo);
     glDeleteVertexArrays(1, &glmesh->vao);
+    if(gl_state.vao == glmesh->vao) gl_state.vao = 0;
 }
 
-static void gl_mesh_bind_attributes(mesh_format_t format) {
-    for(u32 i = 0; i < mesh_format_num_attributes(format); i ++) {
-        glEnableVertexAttribArray(i);
+static void gl_mesh_update_range(mesh_t mesh, u32 attribute, u32 offset, range_t data) {
+    gl_mesh_internal_t* glmesh = mesh_get_internal(mesh);
+
+    if(glmesh->streamed) {
+        mesh_data_t* mesh_data = mesh_get_data(mesh);
+        gl_mesh_stream_advance(glmesh);
+        memcpy(glmesh->mapped[attribute] + glmesh->region * mesh_data->attribute_capacity[attribute] + offset, data.ptr, data.size);
+        return;
+    }
+
+    // the copy target keeps the vao and the array buffer binding out of it
+    glBindBuffer(GL_COPY_WRITE_BUFFER, glmesh->vbos[attribute]);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, data.size, data.ptr);
+}
+
+static void gl_mesh_update_indices(mesh_t mesh, range_t data) {
+    gl_mesh_internal_t* glmesh = mesh_get_internal(mesh);
+
+    if(glmesh->streamed) {
+        mesh_data_t* mesh_data = mesh_get_data(mesh);
+        gl_mesh_stream_advance(glmesh);
+        memcpy(glmesh->mapped_indices + glmesh->region * mesh_data->index_capacity, data.ptr, data.size);
+        return;
     }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, glmesh->index_vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, data.size, data.ptr);
 }
 
 // TEXTURE
 static u32 gl_texture_bind_target(texture_type_t type) {
     switch(type) {
         case TEXTURE_TYPE_2D: return GL_TEXTURE_2D;
+        case TEXTURE_TYPE_2D_ARRAY: return GL_TEXTURE_2D_ARRAY;
         default: UNREACHABLE; return 0;
     }
 }
@@ -1017,6 +1723,16 @@ static u32 gl_texture_filter(texture_filter_t filter) {
     }
 }
 
+// min filter with the level selection folded in, mag never touches the mips
+static u32 gl_texture_min_filter(texture_filter_t filter, texture_mip_filter_t mip_filter) {
+    switch(mip_filter) {
+        case TEXTURE_MIP_FILTER_NONE: return gl_texture_filter(filter);
+        case TEXTURE_MIP_FILTER_NEAREST: return filter == TEXTURE_FILTER_LINEAR ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+        case TEXTURE_MIP_FILTER_LINEAR: return filter == TEXTURE_FILTER_LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+        default: UNREACHABLE; return 0;
+    }
+}
+
 static u32 gl_texture_wrap(texture_wrap_t wrap) {
     switch(wrap) {
         case TEXTURE_WRAP_REPEAT: return GL_REPEAT;
@@ -1033,31 +1749,92 @@ static void gl_texture_init(texture_t texture, texture_info_t info) {
     u32 target = gl_texture_bind_target(info.type);
 
     glGenTextures(1, &gltex->id);
-    glBindTexture(target, gltex->id);
+    gl_bind_texture(0, target, gltex->id);
+
+    // cooked levels are tightly packed, odd sized rows would otherwise get read with 4 byte padding
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // every level gets allocated up front, only supplied mips come with data past the base
+    void* level_data = info.data.ptr;
+    for(u32 level = 0; level < info.mipmaps; level ++) {
+        void* data = (level == 0 || info.mips == TEXTURE_MIPS_SUPPLIED) ? level_data : NULL;
+        u32 width = texture_mip_size(info.width, level);
+        u32 height = texture_mip_size(info.height, level);
+
+        if(info.type == TEXTURE_TYPE_2D_ARRAY) {
+            glTexImage3D(
+                target,
+                level,
+                gl_texture_internalformat(info.format),
+                width,
+                height,
+                info.layers,
+                0,
+                gl_texture_format(info.format),
+                gl_texture_data_type(info.format),
+                data
+            );
+        } else {
+            glTexImage2D(
+                target,
+                level,
+                gl_texture_internalformat(info.format),
+                width,
+                height,
+                0, // TODO(nix3l): border?
+                gl_texture_format(info.format),
+                gl_texture_data_type(info.format),
+                data
+            );
+        }
+
+        if(level_data) level_data += texture_mip_level_bytes(info.format, info.width, info.height, info.layers, level);
+    }
+
+    glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, info.mipmaps - 1);
+    if(info.mips == TEXTURE_MIPS_GENERATE && info.data.ptr)
+        glGenerateMipmap(target);
+
+    // without a sampler bound the texture's own state is what gets read, so give it a mip filter too
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
+            gl_texture_min_filter(info.filter, info.mipmaps > 1 ? TEXTURE_MIP_FILTER_LINEAR : TEXTURE_MIP_FILTER_NONE));
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, gl_texture_filter(info.filter));
+    glTexParameteri(target, GL_TEXTURE_WRAP_R, gl_texture_wrap(info.wrap));
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, gl_texture_wrap(info.wrap));
+
+    gl_bind_texture(0, target, 0);
+}
+
+static void gl_texture_update(texture_t texture, texture_region_t region, range_t data) {
+    texture_data_t* texture_data = texture_get_data(texture);
+    gl_texture_internal_t* gltex = texture_get_internal(texture);
+    u32 target = gl_texture_bind_target(texture_data->type);
 
-    glTexImage2D(
-        target,
-        0,
-        gl_texture_internalformat(info.format),
-        info.width,
-        info.height,
-        0, // TODO(nix3l): border?
-        gl_texture_format(info.format),
-        gl_texture_data_type(info.format),
-        info.data.ptr
-    );
+    gl_bind_texture(0, target, gltex->id);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_texture_filter(info.filter));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_texture_filter(info.filter));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_R, gl_texture_wrap(info.wrap));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, gl_texture_wrap(info.wrap));
+    u32 format = gl_texture_format(texture_data->format);
+    u32 type = gl_texture_data_type(texture_data->format);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if(texture_data->type == TEXTURE_TYPE_2D_ARRAY)
+        glTexSubImage3D(target, 0, region.x, region.y, region.layer, region.w, region.h, 1, format, type, data.ptr);
+    else
+        glTexSubImage2D(target, 0, region.x, region.y, region.w, region.h, format, type, data.ptr);
+}
+
+static void gl_texture_generate_mipmaps(texture_t texture) {
+    texture_data_t* texture_data = texture_get_data(texture);
+    gl_texture_internal_t* gltex = texture_get_internal(texture);
+    u32 target = gl_texture_bind_target(texture_data->type);
 
-    glBindTexture(target, 0);
+    gl_bind_texture(0, target, gltex->id);
+    glGenerateMipmap(target);
 }
 
 static void gl_texture_destroy(texture_t texture) {
     gl_texture_internal_t* gltex = texture_get_internal(texture);
     glDeleteTextures(1, &gltex->id);
+    gl_state_forget_texture(gltex->id);
 }
 
 // SAMPLER
@@ -1066,16 +1843,23 @@ static void gl_sampler_init(sampler_t sampler, sampler_info_t info) {
     mem_clear(glsampler, sizeof(gl_sampler_internal_t));
 
     glGenSamplers(1, &glsampler->id);
-    glSamplerParameteri(glsampler->id, GL_TEXTURE_MIN_FILTER, gl_texture_filter(info.min_filter));
+    glSamplerParameteri(glsampler->id, GL_TEXTURE_MIN_FILTER, gl_texture_min_filter(info.min_filter, info.mip_filter));
     glSamplerParameteri(glsampler->id, GL_TEXTURE_MAG_FILTER, gl_texture_filter(info.mag_filter));
     glSamplerParameteri(glsampler->id, GL_TEXTURE_WRAP_R, gl_texture_wrap(info.u_wrap));
     glSamplerParameteri(glsampler->id, GL_TEXTURE_WRAP_S, gl_texture_wrap(info.v_wrap));
     // TODO(nix3l): update for GL_TEXTURE_WRAP_T
+
+    glSamplerParameterf(glsampler->id, GL_TEXTURE_LOD_BIAS, info.lod_bias);
+    if(info.clamp_lod) {
+        glSamplerParameterf(glsampler->id, GL_TEXTURE_MIN_LOD, info.min_lod);
+        glSamplerParameterf(glsampler->id, GL_TEXTURE_MAX_LOD, info.max_lod);
+    }
 }
 
 static void gl_sampler_destroy(sampler_t sampler) {
     gl_sampler_internal_t* glsampler = sampler_get_internal(sampler);
     glDeleteSamplers(1, &glsampler->id);
+    gl_state_forget_sampler(glsampler->id);
 }
 
 // ATTACHMENTS
@@ -1085,7 +1869,7 @@ static void gl_attachments_init(attachments_t att, attachments_info_t info) {
     mem_clear(glatt, sizeof(gl_attachments_internal_t));
 
     glGenFramebuffers(1, &glatt->fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, glatt->fbo);
+    gl_bind_framebuffer(glatt->fbo);
 
     for(u32 i = 0; i < GFX_MAX_COLOUR_ATTACHMENTS; i ++) {
         texture_t tex = info.colours[i];
@@ -1097,10 +1881,14 @@ static void gl_attachments_init(attachments_t att, attachments_info_t info) {
         texture_data_t* tex_data = texture_get_data(tex);
         gl_texture_internal_t* gltex = texture_get_internal(tex);
 
+        // arrays get attached by their first layer
+        if(tex_data->type == TEXTURE_TYPE_2D_ARRAY) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, gltex->id, 0, 0);
+            continue;
+        }
+
         u32 target = gl_texture_bind_target(tex_data->type);
-        glBindTexture(target, gltex->id);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, target, gltex->id, 0);
-        glBindTexture(target, 0);
     }
 
     if(info.depth_stencil.id != GFX_INVALID_ID) {
@@ -1109,17 +1897,19 @@ static void gl_attachments_init(attachments_t att, attachments_info_t info) {
         gl_texture_internal_t* gltex = texture_get_internal(tex);
         u32 target = gl_texture_bind_target(tex_data->type);
 
-        glBindTexture(target, gltex->id);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, target, gltex->id, 0);
-        glBindTexture(target, 0);
+        if(tex_data->type == TEXTURE_TYPE_2D_ARRAY)
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, gltex->id, 0, 0);
+        else
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, target, gltex->id, 0);
     }
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl_bind_framebuffer(0);
 }
 
 static void gl_attachments_destroy(attachments_t att) {
     gl_attachments_internal_t* glatt = attachments_get_internal(att);
     glDeleteFramebuffers(1, &glatt->fbo);
+    if(gl_state.framebuffer == glatt->fbo) gl_bind_framebuffer(0);
 }
 
 // SHADER
@@ -1151,6 +1941,113 @@ static u32 gl_compile_shader(range_t src, shader_pass_type_t type) {
     return id;
 }
 
+// instance buffers are shader storage blocks holding one unsized array of structs, ie
+//  layout(std430) readonly buffer name { instance_t instances[]; };
+// buffer variables come back named like "instances[0].colour", so members get matched on whats after the last dot
+static void gl_shader_init_instance_buffer(shader_data_t* shader_data, gl_shader_internal_t* glshader, uniform_buffer_t* buffer) {
+    u32 block_index = glGetProgramResourceIndex(glshader->program, GL_SHADER_STORAGE_BLOCK, buffer->name);
+    if(block_index == GL_INVALID_INDEX) {
+        LOG_ERR("couldnt find instance buffer [%s] in shader [%s]\n", buffer->name, shader_data->name);
+        return;
+    }
+
+    glShaderStorageBlockBinding(glshader->program, block_index, buffer->index);
+
+    GLenum num_prop = GL_NUM_ACTIVE_VARIABLES;
+    i32 num_vars = 0;
+    glGetProgramResourceiv(glshader->program, GL_SHADER_STORAGE_BLOCK, block_index, 1, &num_prop, 1, NULL, &num_vars);
+    num_vars = MIN(num_vars, GFX_MAX_BLOCK_UNIFORMS);
+
+    GLenum vars_prop = GL_ACTIVE_VARIABLES;
+    i32 vars[GFX_MAX_BLOCK_UNIFORMS];
+    glGetProgramResourceiv(glshader->program, GL_SHADER_STORAGE_BLOCK, block_index, 1, &vars_prop, num_vars, NULL, vars);
+
+    for(i32 i = 0; i < num_vars; i ++) {
+        char name[128];
+        glGetProgramResourceName(glshader->program, GL_BUFFER_VARIABLE, vars[i], sizeof(name), NULL, name);
+        char* member = strrchr(name, '.');
+        member = member ? member + 1 : name;
+
+        GLenum props[] = { GL_OFFSET, GL_TOP_LEVEL_ARRAY_STRIDE };
+        i32 values[2];
+        glGetProgramResourceiv(glshader->program, GL_BUFFER_VARIABLE, vars[i], 2, props, 2, NULL, values);
+
+        if((u32) values[1] != buffer->bytes)
+            LOG_ERR("instance buffer [%s] in shader [%s] has a stride of [%i] but std430 says [%u], is it declared std430?\n",
+                    buffer->name, shader_data->name, values[1], buffer->bytes);
+
+        uniform_t* uniform = NULL;
+        for(u32 j = 0; j < buffer->num; j ++)
+            if(strcmp(buffer->uniforms[j].name, member) == 0) uniform = &buffer->uniforms[j];
+
+        if(!uniform) {
+            LOG_ERR("instance buffer [%s] in shader [%s] has a member [%s] that wasnt listed\n", buffer->name, shader_data->name, member);
+            continue;
+        }
+
+        uniform->glid = vars[i];
+        if((u32) values[0] != uniform->offset)
+            LOG_ERR("member [%s] of instance buffer [%s] in shader [%s] is at offset [%i] but std430 says [%u]\n",
+                    member, buffer->name, shader_data->name, values[0], uniform->offset);
+    }
+}
+
+// hooks every buffer block up to the binding point matching its index, and checks
+// the layout the driver came up with against the std140 one we worked out in shader_init
+static void gl_shader_init_uniform_buffers(shader_data_t* shader_data, gl_shader_internal_t* glshader) {
+    static i32 offset_alignment = 0;
+    if(offset_alignment == 0) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+
+    for(u32 i = 0; i < shader_data->num_buffers; i ++) {
+        uniform_buffer_t* buffer = &shader_data->buffers[i];
+        glGenBuffers(1, &glshader->ubos[i]);
+
+        if(buffer->rate == UNIFORM_BLOCK_RATE_INSTANCE) {
+            // instances sit back to back, theyre indexed in the shader rather than bound one at a time
+            buffer->stride = buffer->bytes;
+            gl_shader_init_instance_buffer(shader_data, glshader, buffer);
+            continue;
+        }
+
+        buffer->stride = ALIGN_UP(buffer->bytes, (u32) offset_alignment);
+
+        u32 block_index = glGetUniformBlockIndex(glshader->program, buffer->name);
+        if(block_index == GL_INVALID_INDEX) {
+            LOG_ERR("couldnt find uniform buffer [%s] in shader [%s]\n", buffer->name, shader_data->name);
+            continue;
+        }
+
+        glUniformBlockBinding(glshader->program, block_index, buffer->index);
+
+        i32 block_bytes;
+        glGetActiveUniformBlockiv(glshader->program, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &block_bytes);
+        if((u32) block_bytes != buffer->bytes)
+            LOG_ERR("uniform buffer [%s] in shader [%s] is [%i] bytes but std140 says [%u], is it declared std140?\n",
+                    buffer->name, shader_data->name, block_bytes, buffer->bytes);
+
+        const char* names[GFX_MAX_BLOCK_UNIFORMS];
+        u32 indices[GFX_MAX_BLOCK_UNIFORMS];
+        i32 offsets[GFX_MAX_BLOCK_UNIFORMS];
+        for(u32 j = 0; j < buffer->num; j ++) names[j] = buffer->uniforms[j].name;
+
+        glGetUniformIndices(glshader->program, buffer->num, names, indices);
+        for(u32 j = 0; j < buffer->num; j ++) {
+            uniform_t* uniform = &buffer->uniforms[j];
+            uniform->glid = indices[j];
+
+            if(indices[j] == GL_INVALID_INDEX) {
+                LOG_ERR("couldnt find uniform [%s] of buffer [%s] in shader [%s]\n", uniform->name, buffer->name, shader_data->name);
+                continue;
+            }
+
+            glGetActiveUniformsiv(glshader->program, 1, &indices[j], GL_UNIFORM_OFFSET, &offsets[j]);
+            if((u32) offsets[j] != uniform->offset)
+                LOG_ERR("uniform [%s] of buffer [%s] in shader [%s] is at offset [%i] but std140 says [%u]\n",
+                        uniform->name, buffer->name, shader_data->name, offsets[j], uniform->offset);
+        }
+    }
+}
+
 static void gl_shader_init(shader_t shader, shader_info_t info) {
     gl_shader_internal_t* glshader = shader_get_internal(shader);
     mem_clear(glshader, sizeof(gl_shader_internal_t));
@@ -1197,6 +2094,8 @@ static void gl_shader_init(shader_t shader, shader_info_t info) {
         shader_data->uniform_block.bytes += uniform_type_get_bytes(uniform_info.type);
     }
 
+    gl_shader_init_uniform_buffers(shader_data, glshader);
+
     glDetachShader(glshader->program, vs_id);
     glDetachShader(glshader->program, fs_id);
     glDeleteShader(vs_id);
@@ -1206,6 +2105,51 @@ static void gl_shader_init(shader_t shader, shader_info_t info) {
 static void gl_shader_destroy(shader_t shader) {
     gl_shader_internal_t* glshader = shader_get_internal(shader);
     glDeleteProgram(glshader->program);
+    if(gl_state.program == glshader->program) gl_use_program(0);
+
+    for(u32 i = 0; i < GFX_MAX_UNIFORM_BLOCKS; i ++)
+        if(glshader->ubos[i]) gl_state_forget_uniform_buffer(glshader->ubos[i]);
+    glDeleteBuffers(GFX_MAX_UNIFORM_BLOCKS, glshader->ubos);
+}
+
+static void gl_shader_map_uniform_buffer(shader_t shader, u32 buffer, u32 count, void** out) {
+    gl_shader_internal_t* glshader = shader_get_internal(shader);
+    shader_data_t* shader_data = shader_get_data(shader);
+    uniform_buffer_t* ubuffer = &shader_data->buffers[buffer];
+
+    u32 bytes = ubuffer->stride * count;
+    glshader->ubo_mapped[buffer] = bytes;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, glshader->ubos[buffer]);
+
+    if(bytes > glshader->ubo_capacity[buffer]) {
+        // grow geometrically so a growing batch doesnt reallocate every frame
+        u32 capacity = MAX(bytes, glshader->ubo_capacity[buffer] * 2);
+        glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+        glshader->ubo_capacity[buffer] = capacity;
+    }
+
+    // invalidating lets the driver hand us fresh memory instead of waiting on draws still reading the old contents
+    *out = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(!*out) LOG_ERR("failed to map uniform buffer [%s] of shader [%s]\n", ubuffer->name, shader_data->name);
+}
+
+static void gl_shader_unmap_uniform_buffer(shader_t shader, u32 buffer) {
+    gl_shader_internal_t* glshader = shader_get_internal(shader);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, glshader->ubos[buffer]);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+}
+
+static void gl_shader_bind_uniform_buffer(shader_t shader, u32 buffer, u32 copy) {
+    gl_shader_internal_t* glshader = shader_get_internal(shader);
+    shader_data_t* shader_data = shader_get_data(shader);
+    uniform_buffer_t* ubuffer = &shader_data->buffers[buffer];
+
+    if(ubuffer->rate == UNIFORM_BLOCK_RATE_INSTANCE) {
+        gl_bind_buffer_range(GL_SHADER_STORAGE_BUFFER, ubuffer->index, glshader->ubos[buffer], 0, glshader->ubo_mapped[buffer]);
+        return;
+    }
+
+    gl_bind_buffer_range(GL_UNIFORM_BUFFER, ubuffer->index, glshader->ubos[buffer], copy * ubuffer->stride, ubuffer->bytes);
 }
 
 static void gl_shader_update_uniforms(shader_t shader, range_t uniforms) {
@@ -1301,42 +2245,46 @@ static u32 gl_blend_func(blend_func_t func) {
 }
 
 static void gl_activate_pipeline(render_pipeline_t pip) {
-    if(pip.depth.enable) {
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(gl_depth_func(pip.depth.func));
-    } else {
-        glDisable(GL_DEPTH_TEST);
-    }
+    gl_set_enabled(GL_DEPTH_TEST, &gl_state.depth_test, pip.depth.enable);
+    if(pip.depth.enable && gl_state_update(&gl_state.depth_func, gl_depth_func(pip.depth.func)))
+        glDepthFunc(gl_state.depth_func);
 
-    if(pip.cull.enable) {
-        glEnable(GL_CULL_FACE);
-        glCullFace(gl_cull_face(pip.cull.face));
-    } else {
-        glDisable(GL_CULL_FACE);
-    }
+    gl_set_enabled(GL_CULL_FACE, &gl_state.cull_face, pip.cull.enable);
+    if(pip.cull.enable && gl_state_update(&gl_state.cull_mode, gl_cull_face(pip.cull.face)))
+        glCullFace(gl_state.cull_mode);
 
+    gl_set_enabled(GL_BLEND, &gl_state.blend, pip.blend.enable);
     if(pip.blend.enable) {
-        glEnable(GL_BLEND);
-        glBlendFunc(gl_blend_func(pip.blend.src_func), gl_blend_func(pip.blend.dst_func));
-    } else {
-        glDisable(GL_BLEND);
+        u32 src = gl_blend_func(pip.blend.src_func);
+        u32 dst = gl_blend_func(pip.blend.dst_func);
+        // both halves have to be checked before either gets written
+        bool changed = gl_state.blend_src != src || gl_state.blend_dst != dst;
+        gl_state.blend_src = src;
+        gl_state.blend_dst = dst;
+
+        if(changed) {
+            gfx_ctx.state_stats.issued ++;
+            glBlendFunc(src, dst);
+        } else {
+            gfx_ctx.state_stats.skipped ++;
+        }
     }
 
     if(pip.draw_attachments.id != GFX_INVALID_ID) {
         gl_attachments_internal_t* glatt = attachments_get_internal(pip.draw_attachments);
-        glBindFramebuffer(GL_FRAMEBUFFER, glatt->fbo);
+        gl_bind_framebuffer(glatt->fbo);
 
         for(u32 i = 0; i < GFX_MAX_COLOUR_ATTACHMENTS; i ++) {
             render_target_t target = pip.colour_targets[i];
             if(!target.enable) continue;
-            glDrawBuffer(GL_COLOR_ATTACHMENT0 + i);
+            gl_draw_buffer(GL_COLOR_ATTACHMENT0 + i);
 
             if(pip.clear.colour && !target.disable_clear)
                 glClearBufferfv(GL_COLOR, i, target.override_clear_col ? target.clear_col.raw : pip.clear.clear_col.raw);
         }
     } else {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glDrawBuffer(GL_BACK);
+        gl_bind_framebuffer(0);
+        gl_draw_buffer(GL_BACK);
 
         if(pip.clear.colour) {
             glClearColor(v4f_expand(pip.clear.clear_col));
@@ -1350,26 +2298,20 @@ static void gl_activate_pipeline(render_pipeline_t pip) {
     if(depth_stencil_clear != 0) glClear(depth_stencil_clear);
 
     gl_shader_internal_t* glshader = shader_get_internal(pip.shader);
-    glUseProgram(glshader->program);
+    gl_use_program(glshader->program);
 }
 
-// TODO(nix3l): !!! THIS IS TEMPORARY !!!
-// TODO(nix3l): !!! THIS IS TEMPORARY !!!
-// TODO(nix3l): !!! THIS IS TEMPORARY !!!
+// NOTE(nix3l): the state cache means the next pipeline only changes what it has to,
+// so all thats left to undo here is the framebuffer. imgui draws into whatever is bound
+// and saves/restores the rest of the state it touches on its own
 static void gl_clear_pipeline(void) {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_BLEND);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glDrawBuffer(GL_BACK);
-    glUseProgram(0);
+    gl_bind_framebuffer(0);
+    gl_draw_buffer(GL_BACK);
 }
 
 static void gl_activate_bindings(render_bindings_t bindings) {
-    mesh_data_t* mesh_data = mesh_get_data(bindings.mesh);
     gl_mesh_internal_t* glmesh = mesh_get_internal(bindings.mesh);
-    glBindVertexArray(glmesh->vao);
-    gl_mesh_bind_attributes(mesh_data->format);
+    gl_bind_vertex_array(glmesh->vao);
 
     for(u32 i = 0; i < GFX_MAX_SAMPLER_SLOTS; i ++) {
         texture_t texture = bindings.texture_samplers[i].texture;
@@ -1379,26 +2321,52 @@ static void gl_activate_bindings(render_bindings_t bindings) {
         texture_data_t* texture_data = texture_get_data(texture);
         gl_texture_internal_t* gltex = texture_get_internal(texture);
 
-        glActiveTexture(GL_TEXTURE0 + i);
-        glBindTexture(gl_texture_bind_target(texture_data->type), gltex->id);
+        gl_bind_texture(i, gl_texture_bind_target(texture_data->type), gltex->id);
 
         if(sampler.id != GFX_INVALID_ID) {
             gl_sampler_internal_t* glsampler = sampler_get_internal(sampler);
-            glBindSampler(i, glsampler->id);
+            gl_bind_sampler(i, glsampler->id);
         }
     }
 }
 
-static void gl_draw(mesh_t mesh) {
+static void gl_draw_mesh(mesh_t mesh, u32 instances) {
     mesh_data_t* mesh_data = mesh_get_data(mesh);
+    gl_mesh_internal_t* glmesh = mesh_get_internal(mesh);
+    u32 primitive = gl_mesh_primitive(mesh_data->primitive);
+
+    // stream meshes draw from their current copy, which the base vertex/index offset pick out
+    u32 base_vertex = 0;
+    usize index_offset = 0;
+    if(glmesh->streamed) {
+        glmesh->region_frame[glmesh->region] = gl_stream.frame;
+        base_vertex = glmesh->region * mesh_data->vertex_capacity;
+        index_offset = glmesh->region * mesh_data->index_capacity;
+    }
 
     if(mesh_data->index_type != MESH_INDEX_NONE) {
-        glDrawElements(gl_mesh_primitive(mesh_data->primitive), mesh_data->count, GL_UNSIGNED_INT, 0);
+        glDrawElementsInstancedBaseVertex(primitive, mesh_data->count, GL_UNSIGNED_INT, (void*) index_offset, instances, base_vertex);
     } else {
-        glDrawArrays(gl_mesh_primitive(mesh_data->primitive), 0, mesh_data->count);
+        glDrawArraysInstanced(primitive, base_vertex, mesh_data->count, instances);
     }
 }
 
+static void gl_draw(mesh_t mesh) {
+    gl_draw_mesh(mesh, 1);
+}
+
+static void gl_draw_instanced(mesh_t mesh, u32 instances) {
+    gl_draw_mesh(mesh, instances);
+}
+
 static void gl_viewport(viewport_t view) {
+    viewport_t* cached = &gl_state.viewport;
+    if(cached->x == view.x && cached->y == view.y && cached->w == view.w && cached->h == view.h) {
+        gfx_ctx.state_stats.skipped ++;
+        return;
+    }
+
+    *cached = view;
+    gfx_ctx.state_stats.issued ++;
     glViewport(view.x, view.y, view.w, view.h);
 }
@@ -3,6 +3,7 @@
 
 #include "base.h"
 #include "memory/memory.h"
+#include "util/intern.h"
 
 #if OS_LINUX || OS_WINDOWS
 #define GFX_SUPPORT_GL (1)
@@ -15,8 +16,6 @@
 #define GFX_INVALID_ID (0)
 
 // TODO(nix3l): optional labels for gfx objects
-// TODO(nix3l): actually use the mipmaps moron
-// TODO(nix3l): backend state cache
 // TOOD(nix3l): err code logging
 // TODO(nix3l): more validation
 
@@ -31,6 +30,9 @@ enum {
     GFX_MAX_COLOUR_ATTACHMENTS = 8,
     GFX_MAX_SHADERS = 8,
     GFX_MAX_UNIFORMS = 64,
+    GFX_MAX_UNIFORM_BLOCKS = 4,
+    GFX_MAX_BLOCK_UNIFORMS = 16,
+    GFX_STREAM_FRAMES = 3, // copies of each stream mesh, ie how many frames the gpu can be behind
 };
 
 typedef enum gfx_backend_t {
@@ -132,12 +134,25 @@ typedef enum mesh_winding_order_t {
     MESH_WINDING_CCW,
 } mesh_winding_order_t;
 
+typedef enum mesh_usage_t {
+    MESH_USAGE_UNDEFINED = 0, // will be assumed static
+    MESH_USAGE_STATIC, // uploaded once, cant be updated
+    MESH_USAGE_DYNAMIC, // updated every now and then
+    // rewritten every frame. each frame gets its own copy of the buffers so the cpu
+    // never has to wait on the gpu still drawing an older frame
+    MESH_USAGE_STREAM,
+} mesh_usage_t;
+
 typedef struct mesh_data_t {
     mesh_format_t format;
     mesh_index_type_t index_type;
     mesh_primitive_t primitive;
     mesh_winding_order_t winding;
+    mesh_usage_t usage;
     u32 count; // either vertex count or index count depending on index_type
+    u32 vertex_capacity; // what the mesh can hold, set from the sizes given at init
+    u32 attribute_capacity[GFX_MAX_VERTEX_ATTRIBS]; // in bytes
+    u32 index_capacity; // in bytes
 } mesh_data_t;
 
 typedef struct mesh_attribute_t {
@@ -150,11 +165,20 @@ typedef struct mesh_info_t {
     mesh_index_type_t index_type;
     mesh_primitive_t primitive;
     mesh_winding_order_t winding;
+    mesh_usage_t usage;
     mesh_attribute_t attributes[GFX_MAX_VERTEX_ATTRIBS];
     range_t indices;
     u32 count;
 } mesh_info_t;
 
+// new contents for a dynamic/stream mesh, laid out like mesh_info_t
+typedef struct mesh_update_t {
+    range_t attributes[GFX_MAX_VERTEX_ATTRIBS]; // empty ranges are left alone, except on stream meshes
+    range_t indices;
+    // 0 keeps the current count. its also kept if any part of the update gets rejected
+    u32 count;
+} mesh_update_t;
+
 // for use in mesh_info_t
 mesh_attribute_t mesh_attribute(void* data, u32 bytes, u32 dimensions);
 
@@ -170,10 +194,20 @@ void mesh_destroy(mesh_t mesh);
 // format *must* be supplied
 // if primitive not supplied, assumed to be triangles
 // if winding order not supplied, assumed to be CCW
+// if usage not supplied, assumed to be static
+// for dynamic/stream meshes the attribute and index sizes set the capacity, their data can be NULL
+// stream meshes need every attribute to hold the same number of vertices, otherwise they end up dynamic
 mesh_t mesh_new(mesh_info_t info);
 
 mesh_data_t* mesh_get_data(mesh_t mesh);
 
+// updates a dynamic/stream mesh, nothing can go past the capacity it was created with
+// stream meshes move onto a fresh copy on their first update in a frame, so their updates have
+// to supply every attribute and the indices. a stream mesh thats not updated keeps drawing its last copy
+void mesh_update(mesh_t mesh, mesh_update_t update);
+// writes data into one attribute starting at offset bytes in, dynamic meshes only
+void mesh_update_range(mesh_t mesh, u32 attribute, u32 offset, range_t data);
+
 // TEXTURE
 // NOTE(nix3l): be careful when updating this, might break some internal translation functions
 typedef enum texture_format_t {
@@ -241,6 +275,7 @@ typedef enum texture_format_t {
 typedef enum texture_type_t {
     TEXTURE_TYPE_UNDEFINED = 0, // will be assumed 2D
     TEXTURE_TYPE_2D,
+    TEXTURE_TYPE_2D_ARRAY, // layers of the same size and format, sampled with sampler2DArray
 } texture_type_t;
 
 typedef enum texture_filter_t {
@@ -249,6 +284,21 @@ typedef enum texture_filter_t {
     TEXTURE_FILTER_LINEAR,
 } texture_filter_t;
 
+// where a texture's mip chain comes from
+typedef enum texture_mips_t {
+    TEXTURE_MIPS_NONE = 0, // just the base level
+    TEXTURE_MIPS_GENERATE, // built on the gpu from the base level
+    // cooked ahead of time: data holds every level largest first, each half the size of the last
+    // (rounded down, never below 1), with all the layers of a level back to back
+    TEXTURE_MIPS_SUPPLIED,
+} texture_mips_t;
+
+typedef enum texture_mip_filter_t {
+    TEXTURE_MIP_FILTER_NONE = 0, // only ever reads the base level
+    TEXTURE_MIP_FILTER_NEAREST,
+    TEXTURE_MIP_FILTER_LINEAR,
+} texture_mip_filter_t;
+
 typedef enum texture_wrap_t {
     TEXTURE_WRAP_UNDEFINED = 0, // will be assumed clamp to edge
     TEXTURE_WRAP_REPEAT,
@@ -263,7 +313,9 @@ typedef struct texture_data_t {
     texture_filter_t filter;
     u32 width;
     u32 height;
-    u32 mipmaps;
+    u32 layers;
+    u32 mipmaps; // number of levels, including the base
+    texture_mips_t mips;
 } texture_data_t;
 
 typedef struct texture_info_t {
@@ -273,10 +325,20 @@ typedef struct texture_info_t {
     texture_filter_t filter;
     u32 width;
     u32 height;
+    u32 layers; // only for arrays, assumed 1 if not supplied
+    // number of levels including the base. for generated/supplied mips 0 means the full chain down to 1x1
     u32 mipmaps;
-    range_t data;
+    texture_mips_t mips;
+    range_t data; // every layer back to back for arrays, can be NULL to upload them later
 } texture_info_t;
 
+// part of one layer of a texture, layer is ignored for non-arrays
+typedef struct texture_region_t {
+    u32 layer;
+    u32 x, y;
+    u32 w, h;
+} texture_region_t;
+
 texture_t texture_alloc();
 void texture_init(texture_t texture, texture_info_t info);
 void texture_discard(texture_t texture);
@@ -285,21 +347,37 @@ texture_t texture_new(texture_info_t info);
 
 texture_data_t* texture_get_data(texture_t texture);
 
+// replaces a whole layer, data has to be width * height pixels in the texture's format
+void texture_upload_layer(texture_t texture, u32 layer, range_t data);
+// replaces part of a layer, data is tightly packed w * h pixels
+// only touches the base level, generated mips have to be rebuilt with texture_generate_mipmaps
+void texture_update_region(texture_t texture, texture_region_t region, range_t data);
+void texture_generate_mipmaps(texture_t texture);
+
 // SAMPLERS
 typedef struct sampler_data_t {
     texture_filter_t min_filter;
     texture_filter_t mag_filter;
+    texture_mip_filter_t mip_filter;
     texture_wrap_t u_wrap;
     texture_wrap_t v_wrap;
+    f32 lod_bias;
+    bool clamp_lod;
+    f32 min_lod, max_lod;
 } sampler_data_t;
 
 typedef struct sampler_info_t {
     texture_filter_t filter;
     texture_filter_t min_filter;
     texture_filter_t mag_filter;
+    texture_mip_filter_t mip_filter; // how levels get picked/blended when minifying
     texture_wrap_t wrap;
     texture_wrap_t u_wrap;
     texture_wrap_t v_wrap;
+    f32 lod_bias; // added to the level the gpu picks, positive is blurrier
+    // only applied with clamp_lod set, so min_lod = max_lod = 0 keeps a sampler on the base level
+    bool clamp_lod;
+    f32 min_lod, max_lod;
 } sampler_info_t;
 
 sampler_t sampler_alloc();
@@ -363,8 +441,10 @@ typedef enum uniform_type_t {
 // TODO(nix3l): uniform array support
 typedef struct uniform_t {
     const char* name;
+    str_id_t id; // interned name, filled in by shader_init
     u32 glid;
     uniform_type_t type;
+    u32 offset; // std140 offset inside its buffer block, unused for loose uniforms
 } uniform_t;
 
 typedef struct uniform_block_t {
@@ -373,6 +453,39 @@ typedef struct uniform_block_t {
     uniform_t uniforms[GFX_MAX_UNIFORMS];
 } uniform_block_t;
 
+// how often a buffer block gets new data
+typedef enum uniform_block_rate_t {
+    UNIFORM_BLOCK_RATE_INVALID = 0,
+    UNIFORM_BLOCK_RATE_PASS, // written once per pass, shared by every draw in it
+    UNIFORM_BLOCK_RATE_DRAW, // one copy per draw, the whole batch gets written in one go
+    // one std430 struct per instance, read in the shader as a storage buffer indexed by gl_InstanceID:
+    //  layout(std430) readonly buffer name { instance_t instances[]; };
+    // uniforms are the members of the struct, bytes its size
+    UNIFORM_BLOCK_RATE_INSTANCE,
+} uniform_block_rate_t;
+
+// a std140 uniform buffer block, ie layout(std140) uniform name { ... };
+// uniforms have to be listed in the same order as theyre declared in the shader
+// bytes is the size of the matching c struct, which has to come out to the std140 size of the block
+// (vec3s and scalars followed by anything 16 byte aligned need explicit padding on the c side)
+typedef struct uniform_buffer_info_t {
+    const char* name;
+    uniform_block_rate_t rate;
+    u32 bytes;
+    uniform_t uniforms[GFX_MAX_BLOCK_UNIFORMS];
+} uniform_buffer_info_t;
+
+typedef struct uniform_buffer_t {
+    const char* name;
+    str_id_t id;
+    u32 index; // binding point, same as its index in the shader
+    uniform_block_rate_t rate;
+    u32 bytes; // std140 size of the block
+    u32 stride; // distance between copies in the buffer, bytes rounded up to the backend's offset alignment
+    u32 num;
+    uniform_t uniforms[GFX_MAX_BLOCK_UNIFORMS];
+} uniform_buffer_t;
+
 typedef enum shader_pass_type_t {
     SHADER_PASS_INVALID = 0,
     SHADER_PASS_VERTEX,
@@ -387,11 +500,14 @@ typedef struct shader_pass_t {
 
 typedef struct shader_data_t {
     const char* name;
+    str_id_t id;
     shader_pass_t vertex_pass;
     shader_pass_t fragment_pass;
     // TODO(nix3l): compute
     shader_vertex_attribute_t attribs[GFX_MAX_VERTEX_ATTRIBS];
     uniform_block_t uniform_block;
+    u32 num_buffers;
+    uniform_buffer_t buffers[GFX_MAX_UNIFORM_BLOCKS];
 } shader_data_t;
 
 typedef struct shader_info_t {
@@ -400,9 +516,11 @@ typedef struct shader_info_t {
     range_t fragment_src;
     shader_vertex_attribute_t attribs[GFX_MAX_VERTEX_ATTRIBS];
     uniform_t uniforms[GFX_MAX_UNIFORMS];
+    uniform_buffer_info_t buffers[GFX_MAX_UNIFORM_BLOCKS];
 } shader_info_t;
 
 shader_t shader_alloc();
+// keeps its own copy of the sources, so they can live in scratch memory
 void shader_init(shader_t shader, shader_info_t info);
 void shader_discard(shader_t shader);
 void shader_destroy(shader_t shader);
@@ -412,12 +530,28 @@ shader_t shader_new(shader_info_t info);
 shader_data_t* shader_get_data(shader_t shader);
 
 u32 shader_get_uniforms_size(shader_t shader);
+// looks a uniform up by its name, ie shader_get_uniform(shader, STR_ID("proj_view"))
+// returns NULL if the shader doesnt have it
+uniform_t* shader_get_uniform(shader_t shader, str_id_t name);
 // updates the shader's uniforms with the given data
 // all uniforms must be updated at once
 // data struct should be identical to uniform struct in shader
 void shader_update_uniforms(shader_t shader, range_t data);
 
+// first buffer block of the shader with the given rate, NULL if it doesnt have one
+uniform_buffer_t* shader_get_uniform_buffer(shader_t shader, uniform_block_rate_t rate);
+// maps room for count copies of the block, copy i starts at i * stride
+// the old contents are thrown away, so everything has to be rewritten before unmapping
+void* shader_map_uniform_buffer(shader_t shader, u32 buffer, u32 count);
+void shader_unmap_uniform_buffer(shader_t shader, u32 buffer);
+// binds one copy of the block for the draws that follow
+// instance buffers always get bound whole, with everything from the last map in them
+void shader_bind_uniform_buffer(shader_t shader, u32 buffer, u32 copy);
+
 // RENDERING
+// NOTE(nix3l): array textures take up one slot, and the layer a draw reads is part of the draw's data
+// rather than the bindings (draw_call_t.layer, which ends up in draw_instance_t.layer for instanced passes)
+// so draws using different layers of the same array can share a batch
 typedef struct sampler_slot_t {
     texture_t texture;
     sampler_t sampler;
@@ -505,6 +639,7 @@ void gfx_activate_pipeline(render_pipeline_t pipeline);
 void gfx_clear_active_pipeline();
 void gfx_supply_bindings(render_bindings_t bindings);
 void gfx_draw();
+void gfx_draw_instanced(u32 instances);
 
 // VIEWPORT
 typedef struct viewport_t {
@@ -513,9 +648,21 @@ typedef struct viewport_t {
 
 void gfx_viewport(viewport_t view);
 
+// STATS
+// state changes the backend actually sent to the driver vs ones the state cache threw away
+typedef struct gfx_state_stats_t {
+    u32 issued;
+    u32 skipped;
+} gfx_state_stats_t;
+
+// rolls the per-frame stats over, call once the frame has been presented
+void gfx_end_frame();
+// stats for the last full frame
+gfx_state_stats_t gfx_state_stats();
+
 // CONTEXT
 typedef struct gfx_ctx_t {
-    arena_t rations;
+    arena_t* rations;
 
     gfx_backend_t backend;
     gfx_backend_info_t backend_info[GFX_BACKEND_NUM];
@@ -523,6 +670,9 @@ typedef struct gfx_ctx_t {
     render_bindings_t active_bindings;
     render_pipeline_t active_pipeline;
 
+    gfx_state_stats_t state_stats;
+    gfx_state_stats_t last_state_stats;
+
     gfx_respool_t* mesh_pool;
     gfx_respool_t* texture_pool;
     gfx_respool_t* sampler_pool;
@@ -271,7 +271,7 @@ void input_drag(mouse_drag_t* drag);
 void input_drag_interrupt(mouse_drag_t* drag);
 
 typedef struct io_ctx_t {
-    arena_t rations;
+    arena_t* rations;
 
     vector_t monitors;
     monitor_t* active_monitor;
@@ -4,6 +4,7 @@
 #include "base.h"
 
 #include "util/util.h"
+#include "util/intern.h"
 
 #include "rations/rations.h"
 #include "stats/stats.h"
@@ -50,12 +51,14 @@ int main(void) {
         .height = y,
         .format = TEXTURE_FORMAT_RGB8,
         .data = range_new(image_data, 0),
+        .mips = TEXTURE_MIPS_GENERATE,
         // .filter = TEXTURE_FILTER_LINEAR,
     });
 
     sampler_t sampler = sampler_new((sampler_info_t) {
         .wrap = TEXTURE_WRAP_REPEAT,
         .filter = TEXTURE_FILTER_NEAREST,
+        .mip_filter = TEXTURE_MIP_FILTER_LINEAR,
     });
 
     while(!window_closing()) {
@@ -88,10 +91,14 @@ int main(void) {
 
         imgui_show();
         window_swap_buffers();
+        gfx_end_frame();
 
-        render_end_frame();
+        rations_end_frame();
     }
 
+    rations_report();
+    rations_save_profile();
+
     debug_render_terminate();
     editor_terminate();
 
@@ -104,6 +111,9 @@ int main(void) {
     window_destroy();
     io_terminate();
     events_terminate();
+    scratch_release();
+    str_table_release();
+    rations_destroy();
 
     return 0;
 }
@@ -1,4 +1,5 @@
 #include "memory.h"
+#include "platform/platform.h"
 
 void mem_clear(void* ptr, usize size) {
     memset(ptr, 0, size);
@@ -24,7 +25,7 @@ range_t range_alloc_new(usize size) {
 
 void range_destroy(range_t* range) {
     range->size = 0;
-    free(range->ptr);
+    mem_free(range->ptr);
     range->ptr = NULL;
 }
 
@@ -34,61 +35,130 @@ vector_t vector_new(void* data, u32 capacity, u32 element_size) {
         .size = 0,
         .capacity = capacity,
         .element_size = element_size,
+        .type = EXPAND_TYPE_IMMUTABLE,
         .data = data,
     };
 }
 
 vector_t vector_alloc_new(u32 capacity, u32 element_size) {
+    return vector_alloc_new_expand(capacity, element_size, EXPAND_TYPE_IMMUTABLE);
+}
+
+vector_t vector_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t expand_type) {
     void* data = mem_calloc(capacity * element_size);
-    if(!data) PANIC("couldnt allocate range\n");
+    if(!data && capacity > 0) PANIC("couldnt allocate range\n");
 
     return (vector_t) {
         .size = 0,
         .capacity = capacity,
         .element_size = element_size,
+        .type = expand_type,
         .data = data,
     };
 }
 
+void vector_resize(vector_t* vector, u32 new_capacity) {
+    if(vector->type == EXPAND_TYPE_IMMUTABLE) return;
+
+    new_capacity = MAX(new_capacity, vector->size);
+    if(vector->capacity == new_capacity) return;
+
+    void* data = mem_realloc(vector->data, (usize) new_capacity * vector->element_size);
+    if(!data && new_capacity > 0) PANIC("couldnt resize vector\n");
+
+    vector->data = data;
+    vector->capacity = new_capacity;
+}
+
+void vector_reserve(vector_t* vector, u32 capacity) {
+    if(vector->capacity >= capacity) return;
+    vector_resize(vector, capacity);
+}
+
+// makes room for count more elements if the vector is allowed to grow on its own
+// returns false if they dont fit
+static bool vector_fit(vector_t* vector, u32 count) {
+    u32 required = vector->size + count;
+    if(required <= vector->capacity) return true;
+    if(vector->type != EXPAND_TYPE_AUTOEXPAND) return false;
+
+    // double so pushing n elements one at a time stays O(n) overall
+    u32 new_capacity = MAX(vector->capacity * 2, 8);
+    vector_resize(vector, MAX(new_capacity, required));
+    return true;
+}
+
 void* vector_push(vector_t* vector) {
-    if(vector->size == vector->capacity) return NULL;
+    if(!vector_fit(vector, 1)) return NULL;
     vector->size ++;
     return vector->data + (vector->size - 1) * vector->element_size;
 }
 
 void* vector_push_data(vector_t* vector, void* data) {
-    if(vector->size == vector->capacity) return NULL;
+    if(!vector_fit(vector, 1)) return NULL;
     void* dest = vector->data + vector->size * vector->element_size;
     vector->size ++;
     memcpy(dest, data, vector->element_size);
     return dest;
 }
 
+void* vector_push_n(vector_t* vector, void* data, u32 count) {
+    if(!vector_fit(vector, count)) return NULL;
+    void* dest = vector->data + vector->size * vector->element_size;
+    vector->size += count;
+    if(data) memcpy(dest, data, (usize) count * vector->element_size);
+    return dest;
+}
+
 void* vector_get(vector_t* vector, u32 index) {
-    if(index > vector->size) return NULL;
+    if(index >= vector->size) return NULL;
     return vector->data + index * vector->element_size;
 }
 
 void vector_fetch(vector_t* vector, u32 index, void* dest) {
-    if(index > vector->size)
+    if(index >= vector->size)
         memset(dest, 0, vector->element_size);
     else
         memcpy(dest, vector->data + index * vector->element_size, vector->element_size);
 }
 
 void vector_remove(vector_t* vector, u32 index) {
-    if(index > vector->size) return;
+    if(index >= vector->size) return;
 
     // move all the elements in front of index back
-    for(u32 i = index; i < vector->size - 1; i ++) {
-        void* curr_start = vector_get(vector, i);
-        void* next_start = vector_get(vector, i + 1);
-        memcpy(curr_start, next_start, vector->element_size);
-    }
+    void* dest = vector->data + index * vector->element_size;
+    memmove(dest, dest + vector->element_size, (vector->size - index - 1) * vector->element_size);
 
     vector->size --;
 }
 
+void vector_remove_swap(vector_t* vector, u32 index) {
+    if(index >= vector->size) return;
+
+    vector->size --;
+    if(index == vector->size) return;
+
+    memcpy(vector->data + index * vector->element_size,
+           vector->data + vector->size * vector->element_size,
+           vector->element_size);
+}
+
+u32 vector_remove_if(vector_t* vector, vector_predicate_fn predicate, void* user_data) {
+    // everything before keep is staying, so just move each kept element down to it
+    u32 keep = 0;
+    for(u32 i = 0; i < vector->size; i ++) {
+        void* element = vector->data + i * vector->element_size;
+        if(predicate(element, user_data)) continue;
+
+        if(keep != i) memcpy(vector->data + keep * vector->element_size, element, vector->element_size);
+        keep ++;
+    }
+
+    u32 removed = vector->size - keep;
+    vector->size = keep;
+    return removed;
+}
+
 void vector_clear(vector_t* vector) {
     vector->size = 0;
 }
@@ -97,14 +167,11 @@ void vector_destroy(vector_t* vector) {
     vector->size = 0;
     vector->capacity = 0;
     vector->element_size = 0;
-    free(vector->data);
+    mem_free(vector->data);
     vector->data = NULL;
 }
 
 // POOLS
-#define HANDLE_INDEX_MASK (0x00FFFFFF)
-#define HANDLE_GEN_MASK   (0xFF000000)
-
 handle_t handle_new(u32 index, u32 generation) {
     return (generation << 24) | (index & HANDLE_INDEX_MASK);
 }
@@ -135,81 +202,86 @@ handle_t handle_inc_gen(handle_t handle) {
     return (gen << 24) | (handle & HANDLE_INDEX_MASK);
 }
 
-pool_t pool_new(void* block, u32 capacity, u32 element_size) {
-    if(!block) PANIC("bad memory block for pool\n");
-
-    pool_element_t* elements = block + capacity * element_size;
+// the free list is threaded through the free elements themselves:
+// a free element doesnt need its handle index (its index is just its position in the array),
+// so those bits store the index of the next free element instead.
+// the generation bits are left alone so handles stay unique across reuse
+#define POOL_FREE_LIST_END (HANDLE_INDEX_MASK)
 
-    for(u32 i = 0; i < capacity; i ++) {
+// links the elements [start, end) into a fresh free list, ending at tail
+static void pool_link_free_elements(pool_element_t* elements, u32 start, u32 end, u32 tail) {
+    for(u32 i = start; i < end; i ++) {
         elements[i] = (pool_element_t) {
-            .handle = handle_new(i, 0),
+            .handle = handle_new(i + 1 < end ? i + 1 : tail, 0),
             .state = POOL_ELEMENT_FREE,
         };
     }
+}
 
-    return (pool_t) {
-        .element_size = element_size,
-
-        .num_in_use = 0,
-        .capacity = capacity,
-        .first_free_element = 0,
-        .first_used_element = 0,
-        .last_used_element = 0,
+// relinks every free element in the pool in ascending order, keeping their generations
+static void pool_rebuild_free_list(pool_t* pool) {
+    u32 head = POOL_FREE_LIST_END;
+    for(u32 i = pool->capacity; i > 0; i --) {
+        pool_element_t* elem = &pool->elements[i - 1];
+        if(elem->state != POOL_ELEMENT_FREE) continue;
+        elem->handle = handle_set_index(elem->handle, head);
+        head = i - 1;
+    }
 
-        .type = EXPAND_TYPE_IMMUTABLE,
+    pool->first_free_element = head;
+}
 
-        .data = block,
-        .elements = elements,
-    };
+// pool blocks are laid out as [data][elements][occupancy bits]
+static u32 pool_occupancy_words(u32 capacity) {
+    return (capacity + 63) / 64;
 }
 
-pool_t pool_alloc_new(u32 capacity, u32 element_size) {
-    void* data = mem_calloc(capacity * element_size);
-    pool_element_t* elements = mem_calloc(capacity * sizeof(pool_element_t));
+// element sizes can be anything, so pad after the data to keep the elements aligned
+static usize pool_elements_offset(u32 capacity, u32 element_size) {
+    return ALIGN_UP((usize) capacity * element_size, _Alignof(pool_element_t));
+}
 
-    if(!data || !elements) PANIC("couldnt allocate memory for pool\n");
+static usize pool_occupancy_offset(u32 capacity, u32 element_size) {
+    usize offset = pool_elements_offset(capacity, element_size) + capacity * sizeof(pool_element_t);
+    // keep the bitmap words aligned
+    return ALIGN_UP(offset, _Alignof(u64));
+}
 
-    for(u32 i = 0; i < capacity; i ++) {
-        elements[i] = (pool_element_t) {
-            .handle = handle_new(i, 0),
-            .state = POOL_ELEMENT_FREE,
-        };
-    }
+usize pool_block_size(u32 capacity, u32 element_size) {
+    return pool_occupancy_offset(capacity, element_size) + pool_occupancy_words(capacity) * sizeof(u64);
+}
 
-    return (pool_t) {
-        .element_size = element_size,
+static void pool_occupancy_set(pool_t* pool, u32 index) {
+    pool->occupancy[index >> 6] |= 1ull << (index & 63);
+}
 
-        .num_in_use = 0,
-        .capacity = capacity,
-        .first_free_element = 0,
-        .first_used_element = 0,
-        .last_used_element = 0,
+static void pool_occupancy_unset(pool_t* pool, u32 index) {
+    pool->occupancy[index >> 6] &= ~(1ull << (index & 63));
+}
 
-        .type = EXPAND_TYPE_IMMUTABLE,
+pool_t pool_new(void* block, u32 capacity, u32 element_size) {
+    return pool_new_expand(block, capacity, element_size, EXPAND_TYPE_IMMUTABLE);
+}
 
-        .data = data,
-        .elements = elements,
-    };
+pool_t pool_alloc_new(u32 capacity, u32 element_size) {
+    return pool_alloc_new_expand(capacity, element_size, EXPAND_TYPE_IMMUTABLE);
 }
 
 pool_t pool_new_expand(void* block, u32 capacity, u32 element_size, expand_type_t type) {
     if(!block) PANIC("bad memory block for pool\n");
 
-    pool_element_t* elements = block + capacity * element_size;
+    pool_element_t* elements = block + pool_elements_offset(capacity, element_size);
+    u64* occupancy = block + pool_occupancy_offset(capacity, element_size);
 
-    for(u32 i = 0; i < capacity; i ++) {
-        elements[i] = (pool_element_t) {
-            .handle = handle_new(i, 0),
-            .state = POOL_ELEMENT_FREE,
-        };
-    }
+    pool_link_free_elements(elements, 0, capacity, POOL_FREE_LIST_END);
+    mem_clear(occupancy, pool_occupancy_words(capacity) * sizeof(u64));
 
     return (pool_t) {
         .element_size = element_size,
 
         .num_in_use = 0,
         .capacity = capacity,
-        .first_free_element = 0,
+        .first_free_element = capacity > 0 ? 0 : POOL_FREE_LIST_END,
         .first_used_element = 0,
         .last_used_element = 0,
 
@@ -217,28 +289,25 @@ pool_t pool_new_expand(void* block, u32 capacity, u32 element_size, expand_type_
 
         .data = block,
         .elements = elements,
+        .occupancy = occupancy,
     };
 }
 
 pool_t pool_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t type) {
     void* data = mem_calloc(capacity * element_size);
     pool_element_t* elements = mem_calloc(capacity * sizeof(pool_element_t));
+    u64* occupancy = mem_calloc(pool_occupancy_words(capacity) * sizeof(u64));
 
-    if(!data || !elements) PANIC("couldnt allocate memory for pool\n");
+    if(!data || !elements || !occupancy) PANIC("couldnt allocate memory for pool\n");
 
-    for(u32 i = 0; i < capacity; i ++) {
-        elements[i] = (pool_element_t) {
-            .handle = handle_new(i, 0),
-            .state = POOL_ELEMENT_FREE,
-        };
-    }
+    pool_link_free_elements(elements, 0, capacity, POOL_FREE_LIST_END);
 
     return (pool_t) {
         .element_size = element_size,
 
         .num_in_use = 0,
         .capacity = capacity,
-        .first_free_element = 0,
+        .first_free_element = capacity > 0 ? 0 : POOL_FREE_LIST_END,
         .first_used_element = 0,
         .last_used_element = 0,
 
@@ -246,112 +315,145 @@ pool_t pool_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t type)
 
         .data = data,
         .elements = elements,
+        .occupancy = occupancy,
     };
 }
 
 void pool_resize(pool_t* pool, u32 new_capacity) {
     if(pool->type == EXPAND_TYPE_IMMUTABLE) return;
     if(pool->capacity == new_capacity) return;
+    if(new_capacity >= POOL_FREE_LIST_END) PANIC("pool capacity too large for handles\n");
+
+    u32 old_words = pool_occupancy_words(pool->capacity);
+    u32 new_words = pool_occupancy_words(new_capacity);
 
     void* data = mem_realloc(pool->data, new_capacity * pool->element_size);
     pool_element_t* elements = mem_realloc(pool->elements, new_capacity * sizeof(pool_element_t));
+    u64* occupancy = mem_realloc(pool->occupancy, new_words * sizeof(u64));
 
-    if(!data || !elements) PANIC("couldnt prepare memory for pool\n");
-
-    if(new_capacity > pool->capacity) {
-        for(u32 i = pool->capacity + 1; i < new_capacity; i ++) {
-            elements[i] = (pool_element_t) {
-                .handle = handle_new(i, 0),
-                .state = POOL_ELEMENT_FREE,
-            };
-        }
-    }
+    if(!data || !elements || (!occupancy && new_words > 0)) PANIC("couldnt prepare memory for pool\n");
 
+    u32 old_capacity = pool->capacity;
     pool->capacity = new_capacity;
     pool->data = data;
     pool->elements = elements;
+    pool->occupancy = occupancy;
+
+    if(new_words > old_words) mem_clear(occupancy + old_words, (new_words - old_words) * sizeof(u64));
+    // drop any bits past the new end
+    if(new_capacity < old_capacity && (new_capacity & 63))
+        occupancy[new_words - 1] &= (1ull << (new_capacity & 63)) - 1;
+
+    if(new_capacity > old_capacity) {
+        // new elements go on the front of the free list
+        pool_link_free_elements(elements, old_capacity, new_capacity, pool->first_free_element);
+        pool->first_free_element = old_capacity;
+    } else {
+        // the free list might point past the new end, so just relink it
+        pool_rebuild_free_list(pool);
+
+        // and anything in use past the end just got dropped, so recount whats left off the bitmap
+        pool->num_in_use = 0;
+        pool->first_used_element = 0;
+        pool->last_used_element = 0;
+        for(u32 w = 0; w < new_words; w ++) {
+            u64 bits = occupancy[w];
+            if(!bits) continue;
+
+            if(pool->num_in_use == 0) pool->first_used_element = w * 64 + CTZ64(bits);
+            pool->last_used_element = w * 64 + 63 - CLZ64(bits);
+            pool->num_in_use += POPCOUNT64(bits);
+        }
+    }
 }
 
 void pool_prepare(pool_t* pool, u32 num_new_elements) {
     pool_resize(pool, pool->capacity + num_new_elements);
 }
 
+// marks a free element as in use with a new generation
+static handle_t pool_claim_element(pool_t* pool, u32 index) {
+    pool_element_t elem = pool->elements[index];
+    elem.state = POOL_ELEMENT_IN_USE;
+    elem.handle = handle_set_index(handle_inc_gen(elem.handle), index);
+    pool->elements[index] = elem;
+    pool_occupancy_set(pool, index);
+
+    if(pool->num_in_use == 0) {
+        pool->first_used_element = index;
+        pool->last_used_element = index;
+    } else {
+        if(index < pool->first_used_element) pool->first_used_element = index;
+        if(index > pool->last_used_element) pool->last_used_element = index;
+    }
+
+    pool->num_in_use ++;
+    return elem.handle;
+}
+
 void* pool_push(pool_t* pool, handle_t* out_handle) {
-    if(pool->num_in_use == pool->capacity) {
-        // if the first free element is used,
-        // then the pool is at capacity, and should be expanded if necessary
+    if(pool->first_free_element == POOL_FREE_LIST_END) {
+        // no free elements left, expand if we are allowed to
         if(pool->type != EXPAND_TYPE_AUTOEXPAND) return NULL;
 
         // TODO(nix3l): figure out a good number for this.
         pool_prepare(pool, 32);
-
-        pool->first_free_element ++;
     }
 
-    pool_element_t elem = pool->elements[pool->first_free_element];
-    elem.state = POOL_ELEMENT_IN_USE;
-    elem.handle = handle_inc_gen(elem.handle);
-    pool->elements[handle_index(elem.handle)] = elem;
+    // pop the head of the free list
+    u32 index = pool->first_free_element;
+    pool->first_free_element = handle_index(pool->elements[index].handle);
 
-    for(u32 i = pool->first_free_element; i < pool->capacity; i ++) {
-        if(pool->elements[i].state == POOL_ELEMENT_FREE) {
-            pool->first_free_element = i;
-            break;
-        }
-    }
-
-    u32 index = handle_index(elem.handle);
-    if(index < pool->first_used_element) pool->first_used_element = index;
-    if(index > pool->last_used_element) pool->last_used_element = index;
-    pool->num_in_use ++;
-
-    if(out_handle) *out_handle = elem.handle;
+    handle_t handle = pool_claim_element(pool, index);
+    if(out_handle) *out_handle = handle;
 
     return pool->data + index * pool->element_size;
 }
 
 void* pool_set(pool_t* pool, u32 index, handle_t* out_handle) {
-    if(index > pool->capacity) return NULL;
-    
-    pool_element_t elem = pool->elements[pool->first_free_element];
-    elem.state = POOL_ELEMENT_IN_USE;
-    elem.handle = handle_inc_gen(elem.handle);
-    pool->elements[handle_index(elem.handle)] = elem;
-
-    for(u32 i = pool->first_free_element; i < pool->capacity; i ++) {
-        if(pool->elements[i].state == POOL_ELEMENT_FREE) {
-            pool->first_free_element = i;
-            break;
+    if(index >= pool->capacity) return NULL;
+
+    pool_element_t* elem = &pool->elements[index];
+    if(elem->state == POOL_ELEMENT_FREE) {
+        // unlink it from the free list
+        // this has to walk the list, but setting specific indices should be rare
+        u32 next = handle_index(elem->handle);
+        if(pool->first_free_element == index) {
+            pool->first_free_element = next;
+        } else {
+            u32 prev = pool->first_free_element;
+            while(handle_index(pool->elements[prev].handle) != index)
+                prev = handle_index(pool->elements[prev].handle);
+
+            pool->elements[prev].handle = handle_set_index(pool->elements[prev].handle, next);
         }
-    }
 
-    if(index < pool->first_used_element) pool->first_used_element = index;
-    if(index > pool->last_used_element) pool->last_used_element = index;
-    pool->num_in_use ++;
-
-    if(out_handle) *out_handle = elem.handle;
+        handle_t handle = pool_claim_element(pool, index);
+        if(out_handle) *out_handle = handle;
+    } else {
+        // already in use, bump the generation so any old handles become stale
+        elem->state = POOL_ELEMENT_IN_USE;
+        elem->handle = handle_inc_gen(elem->handle);
+        pool_occupancy_set(pool, index);
+        if(out_handle) *out_handle = elem->handle;
+    }
 
-    return pool->data + handle_index(elem.handle) * pool->element_size;
+    return pool->data + index * pool->element_size;
 }
 
 void* pool_get(pool_t* pool, handle_t handle) {
     u32 index = handle_index(handle);
-    if(index > pool->capacity) return NULL;
+    if(index >= pool->capacity) return NULL;
 
-    // bit of an optimisation
-    // probably doesnt speed it up all that much but hey its there
-    if(index < pool->first_used_element || index > pool->last_used_element)
-        return NULL;
-
-    for(u32 i = pool->first_used_element; i <= pool->last_used_element; i ++) {
-        pool_element_t curr_elem = pool->elements[i];
-        if(curr_elem.state == POOL_ELEMENT_FREE) continue;
-
-        if(handle == curr_elem.handle)
-            return pool->data + i * pool->element_size;
-    }
+    // the handle already tells us which slot it lives in,
+    // so all we have to do is make sure the slot hasnt been freed/reused since.
+    // the element stores the handle with its current generation,
+    // so any stale handle wont match it
+    pool_element_t elem = pool->elements[index];
+    if(elem.state == POOL_ELEMENT_FREE) return NULL;
+    if(elem.handle != handle) return NULL;
 
-    return NULL;
+    return pool->data + index * pool->element_size;
 }
 
 void* pool_at_index(pool_t* pool, u32 index) {
@@ -361,45 +463,26 @@ void* pool_at_index(pool_t* pool, u32 index) {
 
 void pool_free(pool_t* pool, handle_t handle) {
     u32 index = handle_index(handle);
-    if(index > pool->capacity) return;
+    if(index >= pool->capacity) return;
 
     pool_element_t elem = pool->elements[index];
+    if(elem.state == POOL_ELEMENT_FREE) return;
+
+    // push it onto the front of the free list
     elem.state = POOL_ELEMENT_FREE;
-    elem.handle = handle_inc_gen(elem.handle);
+    elem.handle = handle_set_index(handle_inc_gen(elem.handle), pool->first_free_element);
     pool->elements[index] = elem;
+    pool->first_free_element = index;
+    pool_occupancy_unset(pool, index);
 
     pool->num_in_use --;
 
-    // NOTE(nix3l): while these look scary for performance,
-    // if you think about it, these loops will probably never iterate over 2-3 times in the WORST cases
-    // since if the pools are working as they should, the used elements should be more closely packed
-    // and not sparse
-
+    // NOTE(nix3l): first_used_element/last_used_element are only bounds now,
+    // they dont get shrunk when freeing (that would need a scan).
+    // anything walking between them has to check the element state anyway
     if(pool->num_in_use == 0) {
         pool->first_used_element = 0;
         pool->last_used_element = 0;
-        pool->first_free_element = 0;
-    } else {
-        // check if the first free element changed
-        if(index < pool->first_free_element) pool->first_free_element = index;
-
-        // if we freed the first used element, find the next used element
-        if(index == pool->first_used_element) {
-            for(u32 i = index; i <= pool->last_used_element; i ++) {
-                if(pool->elements[i].state != POOL_ELEMENT_FREE) {
-                    pool->first_used_element = i;
-                    break;
-                }
-            }
-        // if we freed the last used element, find the previous used element
-        } else if(index == pool->last_used_element) {
-            for(u32 i = index; i >= pool->first_used_element; i --) {
-                if(pool->elements[i].state != POOL_ELEMENT_FREE) {
-                    pool->last_used_element = i;
-                    break;
-                }
-            }
-        }
     }
 
     // TODO(nix3l): finish
@@ -411,15 +494,12 @@ void pool_free(pool_t* pool, handle_t handle) {
 }
 
 void pool_clear(pool_t* pool) {
-    for(u32 i = 0; i < pool->capacity; i ++) {
-        pool_element_t elem = pool->elements[i];
-        elem.state = POOL_ELEMENT_FREE;
-        elem.handle = handle_set_gen(elem.handle, 0);
-        pool->elements[i] = elem;
-    }
+    pool_link_free_elements(pool->elements, 0, pool->capacity, POOL_FREE_LIST_END);
+    mem_clear(pool->occupancy, pool_occupancy_words(pool->capacity) * sizeof(u64));
 
-    pool->first_free_element = 0;
+    pool->first_free_element = pool->capacity > 0 ? 0 : POOL_FREE_LIST_END;
     pool->first_used_element = 0;
+    pool->last_used_element = 0;
     pool->num_in_use = 0;
 }
 
@@ -427,50 +507,288 @@ void pool_destroy(pool_t* pool) {
     pool->num_in_use = 0;
     pool->element_size = 0;
     pool->capacity = 0;
-    pool->first_free_element = 0;
+    pool->first_free_element = POOL_FREE_LIST_END;
     pool->first_used_element = 0;
+    pool->last_used_element = 0;
 
     mem_free(pool->data);
     pool->data = NULL;
     mem_free(pool->elements);
     pool->elements = NULL;
+    mem_free(pool->occupancy);
+    pool->occupancy = NULL;
+}
+
+// returns the index of the first in-use element at or after from, or capacity if there are none
+static u32 pool_find_in_use(pool_t* pool, u32 from) {
+    if(from >= pool->capacity) return pool->capacity;
+
+    u32 word = from >> 6;
+    u32 num_words = pool_occupancy_words(pool->capacity);
+    // mask off everything before from in the first word
+    u64 bits = pool->occupancy[word] & (~0ull << (from & 63));
+
+    while(bits == 0) {
+        if(++ word >= num_words) return pool->capacity;
+        bits = pool->occupancy[word];
+    }
+
+    return MIN((word << 6) + CTZ64(bits), pool->capacity);
+}
+
+// returns the index of the first free element at or after from, or capacity if there are none
+static u32 pool_find_free(pool_t* pool, u32 from) {
+    if(from >= pool->capacity) return pool->capacity;
+
+    u32 word = from >> 6;
+    u32 num_words = pool_occupancy_words(pool->capacity);
+    u64 bits = ~pool->occupancy[word] & (~0ull << (from & 63));
+
+    while(bits == 0) {
+        if(++ word >= num_words) return pool->capacity;
+        bits = ~pool->occupancy[word];
+    }
+
+    return MIN((word << 6) + CTZ64(bits), pool->capacity);
 }
 
 bool pool_iter(pool_t* pool, pool_iter_t* iter) {
     // if(!pool || !iter) return false;
     if(pool->num_in_use == 0) return false;
 
-    if(iter->absolute_index > pool->last_used_element) {
+    // the first iteration starts at absolute_index (so callers can skip reserved elements),
+    // every iteration after that starts right after the last element we returned
+    u32 start = iter->iteration == 0 ? MAX(iter->absolute_index, pool->first_used_element) : iter->absolute_index + 1;
+    if(start > pool->last_used_element) {
         iter->data = NULL;
         return false;
     }
 
-    bool found_elem = false;
-    pool_element_t elem;
-    if(iter->iteration == 0 && (iter->absolute_index < pool->first_used_element || iter->absolute_index == 0)) {
-        elem = pool->elements[pool->first_used_element];
-        iter->absolute_index = pool->first_used_element;
-    } else if(iter->iteration > 0) {
-        for(u32 i = iter->absolute_index + 1; i <= pool->last_used_element; i ++) {
-            elem = pool->elements[i];
-            if(elem.state == POOL_ELEMENT_IN_USE) {
-                iter->absolute_index = i;
-                found_elem = true;
-                break;
-            }
-        }
-
-        if(!found_elem) return false;
-    } else {
-        elem = pool->elements[iter->absolute_index];
+    u32 i = pool_find_in_use(pool, start);
+    if(i > pool->last_used_element) {
+        iter->data = NULL;
+        return false;
     }
 
     iter->iteration ++;
-    iter->handle = elem.handle;
-    iter->data = pool_at_index(pool, iter->absolute_index);
+    iter->absolute_index = i;
+    iter->handle = pool->elements[i].handle;
+    iter->data = pool->data + i * pool->element_size;
+    return true;
+}
+
+bool pool_iter_runs(pool_t* pool, pool_run_iter_t* iter) {
+    if(pool->num_in_use == 0) return false;
+
+    u32 start = pool_find_in_use(pool, MAX(iter->absolute_index, pool->first_used_element));
+    if(start > pool->last_used_element) {
+        iter->run = (pool_run_t) {0};
+        return false;
+    }
+
+    u32 end = MIN(pool_find_free(pool, start + 1), pool->last_used_element + 1);
+
+    iter->absolute_index = end;
+    iter->run = (pool_run_t) {
+        .data = pool->data + start * pool->element_size,
+        .start = start,
+        .count = end - start,
+    };
+
     return true;
 }
 
+handle_t pool_handle_at_index(pool_t* pool, u32 index) {
+    return pool->elements[index].handle;
+}
+
+// DENSE POOLS
+// dense pool blocks are laid out as [data][dense_to_sparse][slots]
+static usize dense_pool_index_offset(u32 capacity, u32 element_size) {
+    return ALIGN_UP((usize) capacity * element_size, _Alignof(u32));
+}
+
+static usize dense_pool_slots_offset(u32 capacity, u32 element_size) {
+    usize offset = dense_pool_index_offset(capacity, element_size) + capacity * sizeof(u32);
+    return ALIGN_UP(offset, _Alignof(dense_slot_t));
+}
+
+usize dense_pool_block_size(u32 capacity, u32 element_size) {
+    return dense_pool_slots_offset(capacity, element_size) + capacity * sizeof(dense_slot_t);
+}
+
+// links the slots [start, end) into a free list ending at tail
+// free slots reuse dense_index as the next link, same idea as pools
+static void dense_pool_link_free_slots(dense_slot_t* slots, u32 start, u32 end, u32 tail) {
+    for(u32 i = start; i < end; i ++) {
+        slots[i] = (dense_slot_t) {
+            .handle = handle_new(i, 0),
+            .dense_index = i + 1 < end ? i + 1 : tail,
+            .state = POOL_ELEMENT_FREE,
+        };
+    }
+}
+
+dense_pool_t dense_pool_new(void* block, u32 capacity, u32 element_size) {
+    if(!block) PANIC("bad memory block for dense pool\n");
+    if(capacity >= POOL_FREE_LIST_END) PANIC("dense pool capacity too large for handles\n");
+
+    u32* dense_to_sparse = block + dense_pool_index_offset(capacity, element_size);
+    dense_slot_t* slots = block + dense_pool_slots_offset(capacity, element_size);
+    dense_pool_link_free_slots(slots, 0, capacity, POOL_FREE_LIST_END);
+
+    return (dense_pool_t) {
+        .element_size = element_size,
+
+        .count = 0,
+        .capacity = capacity,
+        .first_free_slot = capacity > 0 ? 0 : POOL_FREE_LIST_END,
+
+        .type = EXPAND_TYPE_IMMUTABLE,
+
+        .data = block,
+        .dense_to_sparse = dense_to_sparse,
+        .slots = slots,
+    };
+}
+
+dense_pool_t dense_pool_alloc_new(u32 capacity, u32 element_size) {
+    return dense_pool_alloc_new_expand(capacity, element_size, EXPAND_TYPE_IMMUTABLE);
+}
+
+dense_pool_t dense_pool_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t type) {
+    if(capacity >= POOL_FREE_LIST_END) PANIC("dense pool capacity too large for handles\n");
+
+    void* data = mem_calloc(capacity * element_size);
+    u32* dense_to_sparse = mem_calloc(capacity * sizeof(u32));
+    dense_slot_t* slots = mem_calloc(capacity * sizeof(dense_slot_t));
+
+    if(!data || !dense_to_sparse || !slots) PANIC("couldnt allocate memory for dense pool\n");
+
+    dense_pool_link_free_slots(slots, 0, capacity, POOL_FREE_LIST_END);
+
+    return (dense_pool_t) {
+        .element_size = element_size,
+
+        .count = 0,
+        .capacity = capacity,
+        .first_free_slot = capacity > 0 ? 0 : POOL_FREE_LIST_END,
+
+        .type = type,
+
+        .data = data,
+        .dense_to_sparse = dense_to_sparse,
+        .slots = slots,
+    };
+}
+
+void dense_pool_prepare(dense_pool_t* pool, u32 num_new_elements) {
+    if(pool->type == EXPAND_TYPE_IMMUTABLE) return;
+    if(num_new_elements == 0) return;
+
+    u32 new_capacity = pool->capacity + num_new_elements;
+    if(new_capacity >= POOL_FREE_LIST_END) PANIC("dense pool capacity too large for handles\n");
+
+    void* data = mem_realloc(pool->data, new_capacity * pool->element_size);
+    u32* dense_to_sparse = mem_realloc(pool->dense_to_sparse, new_capacity * sizeof(u32));
+    dense_slot_t* slots = mem_realloc(pool->slots, new_capacity * sizeof(dense_slot_t));
+
+    if(!data || !dense_to_sparse || !slots) PANIC("couldnt prepare memory for dense pool\n");
+
+    dense_pool_link_free_slots(slots, pool->capacity, new_capacity, pool->first_free_slot);
+    pool->first_free_slot = pool->capacity;
+
+    pool->capacity = new_capacity;
+    pool->data = data;
+    pool->dense_to_sparse = dense_to_sparse;
+    pool->slots = slots;
+}
+
+void* dense_pool_push(dense_pool_t* pool, handle_t* out_handle) {
+    if(pool->first_free_slot == POOL_FREE_LIST_END) {
+        if(pool->type != EXPAND_TYPE_AUTOEXPAND) return NULL;
+        // same growth as regular pools
+        dense_pool_prepare(pool, 32);
+    }
+
+    u32 slot_index = pool->first_free_slot;
+    dense_slot_t* slot = &pool->slots[slot_index];
+    pool->first_free_slot = slot->dense_index;
+
+    // there are as many slots as elements, so a free slot means theres room at the end
+    u32 dense_index = pool->count ++;
+    slot->handle = handle_inc_gen(slot->handle);
+    slot->dense_index = dense_index;
+    slot->state = POOL_ELEMENT_IN_USE;
+    pool->dense_to_sparse[dense_index] = slot_index;
+
+    if(out_handle) *out_handle = slot->handle;
+    return pool->data + dense_index * pool->element_size;
+}
+
+void* dense_pool_get(dense_pool_t* pool, handle_t handle) {
+    u32 slot_index = handle_index(handle);
+    if(slot_index >= pool->capacity) return NULL;
+
+    dense_slot_t slot = pool->slots[slot_index];
+    if(slot.state != POOL_ELEMENT_IN_USE || slot.handle != handle) return NULL;
+
+    return pool->data + slot.dense_index * pool->element_size;
+}
+
+void* dense_pool_at(dense_pool_t* pool, u32 dense_index) {
+    if(dense_index >= pool->count) return NULL;
+    return pool->data + dense_index * pool->element_size;
+}
+
+handle_t dense_pool_handle_at(dense_pool_t* pool, u32 dense_index) {
+    return pool->slots[pool->dense_to_sparse[dense_index]].handle;
+}
+
+void dense_pool_free(dense_pool_t* pool, handle_t handle) {
+    u32 slot_index = handle_index(handle);
+    if(slot_index >= pool->capacity) return;
+
+    dense_slot_t* slot = &pool->slots[slot_index];
+    if(slot->state != POOL_ELEMENT_IN_USE || slot->handle != handle) return;
+
+    // move the last element into the hole to keep everything packed
+    u32 hole = slot->dense_index;
+    u32 last = -- pool->count;
+    if(hole != last) {
+        memcpy(pool->data + hole * pool->element_size, pool->data + last * pool->element_size, pool->element_size);
+
+        u32 moved_slot = pool->dense_to_sparse[last];
+        pool->dense_to_sparse[hole] = moved_slot;
+        pool->slots[moved_slot].dense_index = hole;
+    }
+
+    slot->handle = handle_inc_gen(slot->handle);
+    slot->state = POOL_ELEMENT_FREE;
+    slot->dense_index = pool->first_free_slot;
+    pool->first_free_slot = slot_index;
+}
+
+void dense_pool_clear(dense_pool_t* pool) {
+    dense_pool_link_free_slots(pool->slots, 0, pool->capacity, POOL_FREE_LIST_END);
+    pool->first_free_slot = pool->capacity > 0 ? 0 : POOL_FREE_LIST_END;
+    pool->count = 0;
+}
+
+void dense_pool_destroy(dense_pool_t* pool) {
+    pool->count = 0;
+    pool->capacity = 0;
+    pool->element_size = 0;
+    pool->first_free_slot = POOL_FREE_LIST_END;
+
+    mem_free(pool->data);
+    pool->data = NULL;
+    mem_free(pool->dense_to_sparse);
+    pool->dense_to_sparse = NULL;
+    mem_free(pool->slots);
+    pool->slots = NULL;
+}
+
 // ARENAS
 arena_t arena_new(range_t block) {
     return (arena_t) {
@@ -514,9 +832,53 @@ arena_t arena_alloc_new_expand(usize capacity, expand_type_t expand_type) {
     };
 }
 
+arena_t arena_virtual_new(usize reserve_size, bool huge_pages) {
+    usize page_size = platform_page_size();
+    reserve_size = (reserve_size + page_size - 1) & ~(page_size - 1);
+
+    void* data = platform_mem_reserve(reserve_size);
+    if(!data) PANIC("couldnt reserve memory for arena\n");
+
+    if(huge_pages) platform_mem_hint_huge_pages(data, reserve_size);
+
+    return arena_virtual_new_in(range_new(data, reserve_size), 0);
+}
+
+arena_t arena_virtual_new_in(range_t reserved_block, usize committed) {
+    return (arena_t) {
+        .size = 0,
+        .capacity = committed,
+        .data = reserved_block.ptr,
+        .type = EXPAND_TYPE_AUTOEXPAND,
+        .reserved = reserved_block.size,
+    };
+}
+
+// commits enough pages to hold new_capacity bytes
+// returns false if that is past the reserved space
+static bool arena_virtual_commit(arena_t* arena, usize new_capacity) {
+    if(new_capacity <= arena->capacity) return true;
+    if(new_capacity > arena->reserved) return false;
+
+    usize page_size = platform_page_size();
+    usize target = MAX(new_capacity, arena->capacity + ARENA_COMMIT_GRANULARITY);
+    target = (target + page_size - 1) & ~(page_size - 1);
+    target = MIN(target, arena->reserved);
+
+    if(!platform_mem_commit(arena->data + arena->capacity, target - arena->capacity)) return false;
+    arena->capacity = target;
+    return true;
+}
+
 void arena_resize(arena_t* arena, usize new_capacity) {
     if(arena->type == EXPAND_TYPE_IMMUTABLE) return;
 
+    if(arena->reserved) {
+        // never decommit here, shrinking a virtual arena doesnt buy us anything
+        if(!arena_virtual_commit(arena, new_capacity)) PANIC("ran out of reserved space for arena\n");
+        return;
+    }
+
     arena->capacity = new_capacity;
     arena->data = mem_realloc(arena->data, new_capacity);
 
@@ -524,7 +886,9 @@ void arena_resize(arena_t* arena, usize new_capacity) {
 }
 
 void arena_prepare(arena_t* arena, usize bytes) {
-    arena_resize(arena, arena->capacity + bytes);
+    // virtual arenas only need to make sure whats past the head is committed
+    if(arena->reserved) arena_resize(arena, arena->size + bytes);
+    else arena_resize(arena, arena->capacity + bytes);
 }
 
 // TODO(nix3l): should these really be separate functions?
@@ -544,22 +908,49 @@ static void shrink_arena(arena_t* arena) {
 
 void* arena_push(arena_t* arena, u32 bytes) {
     if(arena->size + bytes > arena->capacity) {
-        if(arena->type == EXPAND_TYPE_AUTOEXPAND) grow_arena(arena);
-        else return NULL;
+        arena->overflows ++;
+
+        if(arena->reserved) {
+            if(!arena_virtual_commit(arena, arena->size + bytes)) return NULL;
+        } else if(arena->type == EXPAND_TYPE_AUTOEXPAND) {
+            grow_arena(arena);
+        } else {
+            return NULL;
+        }
     }
 
     void* data = arena->data + arena->size;
     arena->size += bytes;
+    arena->high_water = MAX(arena->high_water, arena->size);
 
     return data;
 }
 
+void* arena_push_aligned(arena_t* arena, u32 bytes, u32 alignment) {
+    if(!IS_POW2(alignment)) PANIC("arena alignment [%u] is not a power of two\n", alignment);
+
+    // growing a normal auto-expanding arena can move it, which would throw off the padding
+    // so make sure theres room for the worst case first
+    if(!arena->reserved && arena->type == EXPAND_TYPE_AUTOEXPAND && !arena_fits(arena, bytes + alignment - 1))
+        arena_prepare(arena, bytes + alignment - 1);
+
+    // the mask has to be as wide as the pointer, a u32 one would clear its upper half
+    usize head = (usize) (arena->data + arena->size);
+    u32 padding = (u32) (ALIGN_UP(head, (usize) alignment) - head);
+
+    void* data = arena_push(arena, padding + bytes);
+    if(!data) return NULL;
+
+    arena->padding += padding;
+    return data + padding;
+}
+
 void* arena_push_to_capacity(arena_t* arena) {
     return arena_push(arena, arena->capacity - arena->size);
 }
 
 void arena_pop(arena_t* arena, u32 bytes) {
-    if(arena->type == EXPAND_TYPE_AUTOEXPAND && arena->size - bytes < arena->capacity * 0.5f)
+    if(!arena->reserved && arena->type == EXPAND_TYPE_AUTOEXPAND && arena->size - bytes < arena->capacity * 0.5f)
         shrink_arena(arena);
 
     if(arena->size <= bytes) arena->size = 0;
@@ -567,9 +958,11 @@ void arena_pop(arena_t* arena, u32 bytes) {
 }
 
 bool arena_fits(arena_t* arena, u32 bytes) {
+    if(arena->reserved) return arena->reserved - arena->size >= bytes;
     return arena->capacity - arena->size >= bytes;
 }
 
+// NOTE(nix3l): for virtual arenas this is only whats committed, not the whole reservation
 usize arena_remaining(arena_t* arena) {
     return arena->capacity - arena->size;
 }
@@ -605,31 +998,484 @@ range_t arena_range_push(arena_t* arena, u32 bytes) {
     };
 }
 
+range_t arena_range_push_aligned(arena_t* arena, u32 bytes, u32 alignment) {
+    void* data = arena_push_aligned(arena, bytes, alignment);
+    if(!data) PANIC("could not push aligned range in arena\n");
+
+    return (range_t) {
+        .ptr = data,
+        .size = bytes
+    };
+}
+
 vector_t arena_vector_push(arena_t* arena, u32 num_elements, u32 element_size) {
     u32 bytes = num_elements * element_size;
-    void* data = arena_push(arena, bytes);
+    void* data = arena_push_aligned(arena, bytes, CACHE_LINE_SIZE);
     if(!data) PANIC("couldnt push enough memory for vector in arena\n");
     return vector_new(data, num_elements, element_size);
 }
 
 pool_t arena_pool_push(arena_t* arena, u32 capacity, u32 element_size) {
-    u32 bytes = capacity * (element_size + sizeof(pool_element_t));
-    void* data = arena_push(arena, bytes);
+    u32 bytes = pool_block_size(capacity, element_size);
+    void* data = arena_push_aligned(arena, bytes, CACHE_LINE_SIZE);
     if(!data) PANIC("couldnt push enough memory for pool in arena\n");
     return pool_new(data, capacity, element_size);
 }
 
+dense_pool_t arena_dense_pool_push(arena_t* arena, u32 capacity, u32 element_size) {
+    u32 bytes = dense_pool_block_size(capacity, element_size);
+    void* data = arena_push_aligned(arena, bytes, CACHE_LINE_SIZE);
+    if(!data) PANIC("couldnt push enough memory for dense pool in arena\n");
+    return dense_pool_new(data, capacity, element_size);
+}
+
 void arena_clear(arena_t* arena) {
     arena->size = 0;
+    arena->padding = 0;
 }
 
 void arena_destroy(arena_t* arena) {
+    if(arena->reserved) platform_mem_release(arena->data, arena->reserved);
+    else mem_free(arena->data);
+
     arena->size = 0;
     arena->capacity = 0;
-    mem_free(arena->data);
+    arena->reserved = 0;
+    arena->padding = 0;
     arena->data = NULL;
 }
 
+// TEMPORARY ARENA SCOPES
+arena_temp_t arena_temp_begin(arena_t* arena) {
+    return (arena_temp_t) {
+        .arena = arena,
+        .size = arena->size,
+        .padding = arena->padding,
+    };
+}
+
+void arena_temp_end(arena_temp_t temp) {
+    // dont shrink auto-expanding arenas here, the memory is probably getting pushed again soon
+    temp.arena->size = temp.size;
+    temp.arena->padding = temp.padding;
+}
+
+// SCRATCH ARENAS
+static THREAD_LOCAL arena_t scratch_arenas[SCRATCH_ARENA_COUNT];
+
+arena_temp_t scratch_begin(arena_t** conflicts, u32 num_conflicts) {
+    for(u32 i = 0; i < SCRATCH_ARENA_COUNT; i ++) {
+        arena_t* scratch = &scratch_arenas[i];
+
+        bool conflicting = false;
+        for(u32 j = 0; j < num_conflicts; j ++) {
+            if(conflicts[j] == scratch) {
+                conflicting = true;
+                break;
+            }
+        }
+
+        if(conflicting) continue;
+
+        if(!scratch->data) *scratch = arena_alloc_new(SCRATCH_ARENA_SIZE);
+        return arena_temp_begin(scratch);
+    }
+
+    PANIC("every scratch arena conflicts, need more than %u\n", SCRATCH_ARENA_COUNT);
+}
+
+void scratch_end(arena_temp_t scratch) {
+    arena_temp_end(scratch);
+}
+
+void scratch_release() {
+    for(u32 i = 0; i < SCRATCH_ARENA_COUNT; i ++) {
+        if(scratch_arenas[i].data) arena_destroy(&scratch_arenas[i]);
+    }
+}
+
+// FRAME ARENAS
+frame_arena_t frame_arena_new(u32 latency, usize frame_budget) {
+    if(latency == 0 || latency > FRAME_ARENA_MAX_LATENCY)
+        PANIC("frame arena latency [%u] has to be between 1 and %u\n", latency, FRAME_ARENA_MAX_LATENCY);
+
+    usize page_size = platform_page_size();
+    frame_budget = ALIGN_UP(MAX(frame_budget, page_size), page_size);
+    if(frame_budget > FRAME_ARENA_RESERVE)
+        PANIC("frame arena budget [%zu] is bigger than the reserve [%u]\n", frame_budget, FRAME_ARENA_RESERVE);
+
+    // one reservation for the whole ring, split into a slice per frame
+    void* block = platform_mem_reserve((usize) latency * FRAME_ARENA_RESERVE);
+    if(!block) PANIC("couldnt reserve memory for frame arena\n");
+
+    frame_arena_t frames = {
+        .latency = latency,
+        .current = 0,
+        .frame = 0,
+        .budget = frame_budget,
+    };
+
+    for(u32 i = 0; i < latency; i ++) {
+        range_t slice = range_new(block + (usize) i * FRAME_ARENA_RESERVE, FRAME_ARENA_RESERVE);
+        if(!platform_mem_commit(slice.ptr, frame_budget)) PANIC("couldnt commit frame arena\n");
+
+        frames.arenas[i] = arena_virtual_new_in(slice, frame_budget);
+    }
+
+    return frames;
+}
+
+arena_t* frame_arena_current(frame_arena_t* frames) {
+    return &frames->arenas[frames->current];
+}
+
+void* frame_arena_push(frame_arena_t* frames, u32 bytes) {
+    void* data = arena_push(frame_arena_current(frames), bytes);
+    if(!data) PANIC("frame arena ran out of reserved space pushing [%u] bytes\n", bytes);
+    return data;
+}
+
+void* frame_arena_push_aligned(frame_arena_t* frames, u32 bytes, u32 alignment) {
+    void* data = arena_push_aligned(frame_arena_current(frames), bytes, alignment);
+    if(!data) PANIC("frame arena ran out of reserved space pushing [%u] bytes\n", bytes);
+    return data;
+}
+
+void frame_arena_advance(frame_arena_t* frames) {
+    arena_t* ending = frame_arena_current(frames);
+
+    frames->high_water = MAX(frames->high_water, ending->size);
+    // NOTE(nix3l): the extra pages stay committed, so the arena->overflows counter only
+    // catches the first time each arena goes over. check the size instead
+    if(ending->size > frames->budget) frames->overflows ++;
+
+    frames->frame ++;
+    frames->current = (frames->current + 1) % frames->latency;
+
+    // this arena was last pushed to `latency` frames ago, so nothing should be using it anymore
+    arena_clear(frame_arena_current(frames));
+}
+
+void frame_arena_destroy(frame_arena_t* frames) {
+    if(frames->latency == 0) return;
+
+    // the slices are all part of the one reservation
+    platform_mem_release(frames->arenas[0].data, (usize) frames->latency * FRAME_ARENA_RESERVE);
+    *frames = (frame_arena_t) {0};
+}
+
+// HASH MAPS
+// blocks are laid out as [hashes][keys][values]
+#define HASHMAP_FILLED_BIT (0x80000000u)
+
+// slot count for a map holding capacity entries at 7/8 load
+static u32 hashmap_slots_for(u32 capacity) {
+    u32 min_slots = capacity + capacity / 7 + 1;
+    u32 slots = 16;
+    while(slots < min_slots) slots <<= 1;
+    return slots;
+}
+
+static u32 hashmap_max_entries(u32 slots) {
+    return slots - slots / 8;
+}
+
+static usize hashmap_keys_offset(u32 slots) {
+    return ALIGN_UP((usize) slots * sizeof(u32), 16);
+}
+
+static usize hashmap_values_offset(u32 slots, u32 key_size) {
+    return ALIGN_UP(hashmap_keys_offset(slots) + (usize) slots * key_size, 16);
+}
+
+static usize hashmap_slots_block_size(u32 slots, u32 key_size, u32 value_size) {
+    return hashmap_values_offset(slots, key_size) + (usize) slots * value_size;
+}
+
+usize hashmap_block_size(u32 capacity, u32 key_size, u32 value_size) {
+    if(key_size == HASHMAP_STRING_KEY) key_size = sizeof(const char*);
+    return hashmap_slots_block_size(hashmap_slots_for(capacity), key_size, value_size);
+}
+
+// sets up a map over a block with the exact number of slots given
+static hashmap_t hashmap_new_slots(void* block, u32 slots, u32 key_size, u32 value_size, bool string_keys, expand_type_t type) {
+    if(!block) PANIC("bad memory block for hash map\n");
+
+    u32* hashes = block;
+    mem_clear(hashes, slots * sizeof(u32));
+
+    return (hashmap_t) {
+        .size = 0,
+        .capacity = slots,
+        .key_size = key_size,
+        .value_size = value_size,
+        .string_keys = string_keys,
+
+        .type = type,
+        .arena = NULL,
+
+        .hashes = hashes,
+        .keys = block + hashmap_keys_offset(slots),
+        .values = block + hashmap_values_offset(slots, key_size),
+    };
+}
+
+// allocates a block from wherever the map gets its memory from
+static void* hashmap_alloc_block(arena_t* arena, u32 slots, u32 key_size, u32 value_size) {
+    usize bytes = hashmap_slots_block_size(slots, key_size, value_size);
+    void* block = arena ? arena_push_aligned(arena, bytes, CACHE_LINE_SIZE) : mem_alloc(bytes);
+    if(!block) PANIC("couldnt allocate memory for hash map\n");
+    return block;
+}
+
+static hashmap_t hashmap_create(arena_t* arena, void* block, u32 capacity, u32 key_size, u32 value_size, expand_type_t type) {
+    bool string_keys = key_size == HASHMAP_STRING_KEY;
+    if(string_keys) key_size = sizeof(const char*);
+
+    u32 slots = hashmap_slots_for(capacity);
+    if(!block) block = hashmap_alloc_block(arena, slots, key_size, value_size);
+
+    hashmap_t map = hashmap_new_slots(block, slots, key_size, value_size, string_keys, type);
+    map.arena = arena;
+    return map;
+}
+
+hashmap_t hashmap_new(void* block, u32 capacity, u32 key_size, u32 value_size) {
+    return hashmap_create(NULL, block, capacity, key_size, value_size, EXPAND_TYPE_IMMUTABLE);
+}
+
+hashmap_t hashmap_alloc_new(u32 capacity, u32 key_size, u32 value_size) {
+    return hashmap_create(NULL, NULL, capacity, key_size, value_size, EXPAND_TYPE_IMMUTABLE);
+}
+
+hashmap_t hashmap_alloc_new_expand(u32 capacity, u32 key_size, u32 value_size, expand_type_t expand_type) {
+    return hashmap_create(NULL, NULL, capacity, key_size, value_size, expand_type);
+}
+
+hashmap_t arena_hashmap_push(arena_t* arena, u32 capacity, u32 key_size, u32 value_size) {
+    return hashmap_create(arena, NULL, capacity, key_size, value_size, EXPAND_TYPE_IMMUTABLE);
+}
+
+hashmap_t arena_hashmap_push_expand(arena_t* arena, u32 capacity, u32 key_size, u32 value_size) {
+    return hashmap_create(arena, NULL, capacity, key_size, value_size, EXPAND_TYPE_AUTOEXPAND);
+}
+
+static u32 hashmap_hash(hashmap_t* map, const void* key) {
+    u64 hash;
+
+    if(map->string_keys) {
+        // fnv-1a
+        const char* str = *(const char**) key;
+        hash = 0xcbf29ce484222325ull;
+        for(; *str; str ++) {
+            hash ^= (u8) *str;
+            hash *= 0x100000001b3ull;
+        }
+    } else if(map->key_size == sizeof(u64)) {
+        // splitmix64 finaliser, most keys will be ids or packed coordinates so this is the hot one
+        u64 x;
+        memcpy(&x, key, sizeof(u64));
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27; x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        hash = x;
+    } else {
+        const u8* bytes = key;
+        hash = 0xcbf29ce484222325ull;
+        for(u32 i = 0; i < map->key_size; i ++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+    }
+
+    return (u32) (hash ^ (hash >> 32)) | HASHMAP_FILLED_BIT;
+}
+
+static bool hashmap_keys_equal(hashmap_t* map, const void* a, const void* b) {
+    if(map->string_keys) return strcmp(*(const char**) a, *(const char**) b) == 0;
+    return memcmp(a, b, map->key_size) == 0;
+}
+
+static void* hashmap_key_at(hashmap_t* map, u32 slot) {
+    return map->keys + (usize) slot * map->key_size;
+}
+
+static void* hashmap_value_at(hashmap_t* map, u32 slot) {
+    return map->values + (usize) slot * map->value_size;
+}
+
+// how far the entry in the slot is from where it wanted to be
+static u32 hashmap_probe_distance(hashmap_t* map, u32 slot) {
+    return (slot - (map->hashes[slot] & (map->capacity - 1))) & (map->capacity - 1);
+}
+
+static void hashmap_move_slot(hashmap_t* map, u32 dest, u32 src) {
+    map->hashes[dest] = map->hashes[src];
+    memcpy(hashmap_key_at(map, dest), hashmap_key_at(map, src), map->key_size);
+    memcpy(hashmap_value_at(map, dest), hashmap_value_at(map, src), map->value_size);
+}
+
+// returns the slot holding the key, or the capacity if its not there
+static u32 hashmap_find(hashmap_t* map, u32 hash, const void* key) {
+    u32 mask = map->capacity - 1;
+    u32 slot = hash & mask;
+
+    for(u32 dist = 0; ; dist ++) {
+        if(map->hashes[slot] == 0) return map->capacity;
+        // we would have kicked this entry out if our key was here
+        if(hashmap_probe_distance(map, slot) < dist) return map->capacity;
+        if(map->hashes[slot] == hash && hashmap_keys_equal(map, hashmap_key_at(map, slot), key)) return slot;
+        slot = (slot + 1) & mask;
+    }
+}
+
+// the key must not be in the map already, and there must be room for it
+// instead of swapping entries down the probe sequence one by one,
+// find where the key belongs and shift the rest of the cluster over by one, which ends up the same
+static u32 hashmap_insert_new(hashmap_t* map, u32 hash, const void* key) {
+    u32 mask = map->capacity - 1;
+    u32 slot = hash & mask;
+
+    for(u32 dist = 0; map->hashes[slot] != 0; dist ++) {
+        if(hashmap_probe_distance(map, slot) < dist) break;
+        slot = (slot + 1) & mask;
+    }
+
+    u32 empty = slot;
+    while(map->hashes[empty] != 0) empty = (empty + 1) & mask;
+
+    for(u32 i = empty; i != slot; i = (i - 1) & mask)
+        hashmap_move_slot(map, i, (i - 1) & mask);
+
+    map->hashes[slot] = hash;
+    memcpy(hashmap_key_at(map, slot), key, map->key_size);
+    map->size ++;
+    return slot;
+}
+
+static void hashmap_rehash(hashmap_t* map, u32 slots) {
+    hashmap_t old = *map;
+
+    void* block = hashmap_alloc_block(map->arena, slots, map->key_size, map->value_size);
+    *map = hashmap_new_slots(block, slots, old.key_size, old.value_size, old.string_keys, old.type);
+    map->arena = old.arena;
+
+    for(u32 i = 0; i < old.capacity; i ++) {
+        if(old.hashes[i] == 0) continue;
+        u32 slot = hashmap_insert_new(map, old.hashes[i], hashmap_key_at(&old, i));
+        memcpy(hashmap_value_at(map, slot), hashmap_value_at(&old, i), map->value_size);
+    }
+
+    if(!old.arena) mem_free(old.hashes);
+}
+
+void hashmap_reserve(hashmap_t* map, u32 capacity) {
+    if(map->type == EXPAND_TYPE_IMMUTABLE) return;
+
+    u32 slots = hashmap_slots_for(MAX(capacity, map->size));
+    if(slots <= map->capacity) return;
+    hashmap_rehash(map, slots);
+}
+
+void* hashmap_get(hashmap_t* map, const void* key) {
+    if(map->size == 0) return NULL;
+
+    u32 slot = hashmap_find(map, hashmap_hash(map, key), key);
+    if(slot == map->capacity) return NULL;
+    return hashmap_value_at(map, slot);
+}
+
+void* hashmap_put(hashmap_t* map, const void* key, const void* value) {
+    u32 hash = hashmap_hash(map, key);
+    u32 slot = hashmap_find(map, hash, key);
+
+    if(slot == map->capacity) {
+        if(map->size + 1 > hashmap_max_entries(map->capacity)) {
+            if(map->type != EXPAND_TYPE_AUTOEXPAND) return NULL;
+            hashmap_rehash(map, map->capacity * 2);
+        }
+
+        slot = hashmap_insert_new(map, hash, key);
+        if(!value) mem_clear(hashmap_value_at(map, slot), map->value_size);
+    }
+
+    void* dest = hashmap_value_at(map, slot);
+    if(value) memcpy(dest, value, map->value_size);
+    return dest;
+}
+
+bool hashmap_remove(hashmap_t* map, const void* key) {
+    if(map->size == 0) return false;
+
+    u32 slot = hashmap_find(map, hashmap_hash(map, key), key);
+    if(slot == map->capacity) return false;
+
+    // shift everything after it back by one until we hit an empty slot or an entry thats already home
+    // so theres never a tombstone to step over
+    u32 mask = map->capacity - 1;
+    u32 next = (slot + 1) & mask;
+    while(map->hashes[next] != 0 && hashmap_probe_distance(map, next) > 0) {
+        hashmap_move_slot(map, slot, next);
+        slot = next;
+        next = (next + 1) & mask;
+    }
+
+    map->hashes[slot] = 0;
+    map->size --;
+    return true;
+}
+
+void* hashmap_get_u64(hashmap_t* map, u64 key) {
+    return hashmap_get(map, &key);
+}
+
+void* hashmap_put_u64(hashmap_t* map, u64 key, const void* value) {
+    return hashmap_put(map, &key, value);
+}
+
+bool hashmap_remove_u64(hashmap_t* map, u64 key) {
+    return hashmap_remove(map, &key);
+}
+
+void* hashmap_get_str(hashmap_t* map, const char* key) {
+    return hashmap_get(map, &key);
+}
+
+void* hashmap_put_str(hashmap_t* map, const char* key, const void* value) {
+    return hashmap_put(map, &key, value);
+}
+
+bool hashmap_remove_str(hashmap_t* map, const char* key) {
+    return hashmap_remove(map, &key);
+}
+
+void hashmap_clear(hashmap_t* map) {
+    map->size = 0;
+    mem_clear(map->hashes, map->capacity * sizeof(u32));
+}
+
+void hashmap_destroy(hashmap_t* map) {
+    if(!map->arena) mem_free(map->hashes);
+    map->size = 0;
+    map->capacity = 0;
+    map->hashes = NULL;
+    map->keys = NULL;
+    map->values = NULL;
+}
+
+bool hashmap_iter(hashmap_t* map, hashmap_iter_t* iter) {
+    while(iter->absolute_index < map->capacity) {
+        u32 slot = iter->absolute_index ++;
+        if(map->hashes[slot] == 0) continue;
+
+        iter->key = hashmap_key_at(map, slot);
+        iter->value = hashmap_value_at(map, slot);
+        return true;
+    }
+
+    return false;
+}
+
 // LINKED LISTS
 llist_t llist_new() {
     return (llist_t) {};
@@ -688,3 +1534,79 @@ bool llist_iter(llist_t* list, llist_iter_t* iter) {
     iter->index ++;
     return true;
 }
+
+// CHUNKED LISTS
+// keeps the elements 16 byte aligned for any simd types in them
+#define CLIST_CHUNK_HEADER_SIZE ALIGN_UP(sizeof(clist_chunk_t), 16)
+
+clist_t clist_new(u32 element_size, u32 chunk_capacity) {
+    if(chunk_capacity == 0) PANIC("chunked list needs at least one element per chunk\n");
+
+    return (clist_t) {
+        .size = 0,
+        .element_size = element_size,
+        .chunk_capacity = chunk_capacity,
+        .first = NULL,
+        .last = NULL,
+    };
+}
+
+void* clist_chunk_data(clist_chunk_t* chunk) {
+    return (void*) chunk + CLIST_CHUNK_HEADER_SIZE;
+}
+
+void* clist_push(clist_t* list, arena_t* arena) {
+    clist_chunk_t* chunk = list->last;
+
+    if(!chunk || chunk->count == list->chunk_capacity) {
+        u32 bytes = CLIST_CHUNK_HEADER_SIZE + list->chunk_capacity * list->element_size;
+        chunk = arena_push_aligned(arena, bytes, CACHE_LINE_SIZE);
+        if(!chunk) PANIC("couldnt push chunk for chunked list\n");
+
+        chunk->next = NULL;
+        chunk->count = 0;
+
+        if(list->last) list->last->next = chunk;
+        else list->first = chunk;
+        list->last = chunk;
+    }
+
+    void* data = clist_chunk_data(chunk) + chunk->count * list->element_size;
+    chunk->count ++;
+    list->size ++;
+    return data;
+}
+
+void* clist_push_data(clist_t* list, arena_t* arena, void* data) {
+    void* dest = clist_push(list, arena);
+    memcpy(dest, data, list->element_size);
+    return dest;
+}
+
+void clist_clear(clist_t* list) {
+    list->size = 0;
+    list->first = NULL;
+    list->last = NULL;
+}
+
+bool clist_iter(clist_t* list, clist_iter_t* iter) {
+    if(list->size == 0) return false;
+
+    if(!iter->chunk) {
+        iter->chunk = list->first;
+        iter->chunk_index = 0;
+        iter->index = 0;
+    } else {
+        iter->chunk_index ++;
+        iter->index ++;
+    }
+
+    if(iter->chunk_index == iter->chunk->count) {
+        if(!iter->chunk->next) return false;
+        iter->chunk = iter->chunk->next;
+        iter->chunk_index = 0;
+    }
+
+    iter->data = clist_chunk_data(iter->chunk) + iter->chunk_index * list->element_size;
+    return true;
+}
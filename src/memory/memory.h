@@ -3,11 +3,34 @@
 
 #include "base.h"
 
-// in case we want to change these later
-#define mem_alloc(_bytes) malloc((_bytes))
-#define mem_calloc(_bytes) calloc(1, (_bytes))
-#define mem_realloc(_buffer, _bytes) realloc((_buffer), (_bytes))
-#define mem_free(_ptr) free((_ptr))
+// goes through the slab allocator by default (see slab.h)
+// define MEMORY_LIBC_ALLOC to use malloc and friends directly
+#if defined(MEMORY_LIBC_ALLOC)
+#   define mem_raw_alloc(_bytes) malloc((_bytes))
+#   define mem_raw_calloc(_bytes) calloc(1, (_bytes))
+#   define mem_raw_realloc(_buffer, _bytes) realloc((_buffer), (_bytes))
+#   define mem_raw_free(_ptr) free((_ptr))
+#else
+#   include "slab.h"
+#   define mem_raw_alloc(_bytes) slab_alloc((_bytes))
+#   define mem_raw_calloc(_bytes) slab_calloc((_bytes))
+#   define mem_raw_realloc(_buffer, _bytes) slab_realloc((_buffer), (_bytes))
+#   define mem_raw_free(_ptr) slab_free((_ptr))
+#endif
+
+// define MEMORY_TRACK_ALLOCS to record where every allocation comes from (see memtrack.h)
+#if defined(MEMORY_TRACK_ALLOCS)
+#   include "memtrack.h"
+#   define mem_alloc(_bytes) memtrack_alloc((_bytes), __FILE__, __LINE__)
+#   define mem_calloc(_bytes) memtrack_calloc((_bytes), __FILE__, __LINE__)
+#   define mem_realloc(_buffer, _bytes) memtrack_realloc((_buffer), (_bytes), __FILE__, __LINE__)
+#   define mem_free(_ptr) memtrack_free((_ptr), __FILE__, __LINE__)
+#else
+#   define mem_alloc(_bytes) mem_raw_alloc((_bytes))
+#   define mem_calloc(_bytes) mem_raw_calloc((_bytes))
+#   define mem_realloc(_buffer, _bytes) mem_raw_realloc((_buffer), (_bytes))
+#   define mem_free(_ptr) mem_raw_free((_ptr))
+#endif
 
 void mem_clear(void* ptr, usize size);
 
@@ -33,29 +56,57 @@ range_t range_alloc_new(usize bytes);
 void range_destroy(range_t* range);
 
 // a copy-on-write range that you can dynamically add and remove elements from
-// currently, no expanding/shrinking
+// auto-expanding vectors grow when pushed past capacity, which moves the data
+// so dont hold on to pointers into those across pushes
 typedef struct vector_t {
     u32 size; // in elements
     u32 capacity; // in elements
     u32 element_size;
+    expand_type_t type;
     void* data;
 } vector_t;
 
+// immutable vector creation
 vector_t vector_new(void* data, u32 capacity, u32 element_size);
 vector_t vector_alloc_new(u32 capacity, u32 element_size);
 
+// expandable vector creation
+// only use the expandable types with vectors that own their memory (vector_alloc_new_expand)
+vector_t vector_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t expand_type);
+
+// only works on non-immutable vectors
+// never shrinks below the current size
+void vector_resize(vector_t* vector, u32 new_capacity);
+// makes sure the vector can hold at least capacity elements without growing again
+// only works on non-immutable vectors
+void vector_reserve(vector_t* vector, u32 capacity);
+
 void* vector_push(vector_t* vector);
 // add the element to the end of the vector
 // copies the data put into it, does NOT store a pointer to the original data
 // returns a pointer to the copied data within the vector
 void* vector_push_data(vector_t* vector, void* data);
+// adds count elements to the end of the vector in one go
+// copies from data if its not NULL, otherwise leaves them as is
+// returns a pointer to the first new element, or NULL if they dont all fit
+void* vector_push_n(vector_t* vector, void* data, u32 count);
 // return a pointer to the data located in the vector
 void* vector_get(vector_t* vector, u32 index);
 // copies the data at the index in the vector to the destination provided
 // destination must have the same size (in bytes) as the element_size of the vector
 void vector_fetch(vector_t* vector, u32 index, void* dest);
 // removes the element and moves all the proceeding elements back 
+// O(n), use vector_remove_swap if the order doesnt matter
 void vector_remove(vector_t* vector, u32 index);
+// removes the element by moving the last element into its place
+// O(1), but doesnt keep the order
+void vector_remove_swap(vector_t* vector, u32 index);
+
+typedef bool (*vector_predicate_fn)(void* element, void* user_data);
+// removes every element the predicate returns true for in a single pass
+// keeps the order of the remaining elements
+// returns the number of removed elements
+u32 vector_remove_if(vector_t* vector, vector_predicate_fn predicate, void* user_data);
 
 // removes all the vectors elements
 void vector_clear(vector_t* vector);
@@ -65,6 +116,9 @@ void vector_destroy(vector_t* vector);
 // POOLS
 typedef u32 handle_t;
 
+#define HANDLE_INDEX_MASK (0x00FFFFFF)
+#define HANDLE_GEN_MASK   (0xFF000000)
+
 handle_t handle_new(u32 index, u32 generation);
 
 u32 handle_index(handle_t handle);
@@ -95,17 +149,27 @@ typedef struct pool_t {
 
     u32 num_in_use;
     u32 capacity; // in number of elements
+    // head of the free list, which is threaded through the free elements' handles
+    // holds the end-of-list index when the pool is full
     u32 first_free_element;
+    // bounds on the used elements, not shrunk when freeing
+    // so check the element state when walking between them
     u32 first_used_element;
     // NOTE(nix3l): make sure to use <= in loop conditions,
-    // as this points to a used element
+    // as this points to the last element that could be in use
     u32 last_used_element;
     expand_type_t type;
 
     void* data;
     pool_element_t* elements;
+    // one bit per element, set when the element is in use
+    // lets iteration skip over free elements 64 at a time
+    u64* occupancy;
 } pool_t;
 
+// number of bytes a block passed to pool_new needs
+usize pool_block_size(u32 capacity, u32 element_size);
+
 // immutable pool creation
 pool_t pool_new(void* block, u32 capacity, u32 element_size);
 pool_t pool_alloc_new(u32 capacity, u32 element_size);
@@ -114,10 +178,12 @@ pool_t pool_alloc_new(u32 capacity, u32 element_size);
 pool_t pool_new_expand(void* block, u32 capacity, u32 element_size, expand_type_t expand_type);
 pool_t pool_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t expand_type);
 
+// shrinking drops any elements past the new end, their handles stop being valid
 void pool_resize(pool_t* pool, u32 new_capacity);
 void pool_prepare(pool_t* pool, u32 num_new_elements);
 
-// returns the memory slot at the first free element in the pool
+// returns the memory slot at the head of the free list
+// O(1), the most recently freed element gets reused first
 void* pool_push(pool_t* pool, handle_t* out_handle);
 // forcefully sets element at index
 // removes any data that was there before pushing
@@ -127,6 +193,7 @@ void* pool_set(pool_t* pool, u32 index, handle_t* out_handle);
 void* pool_get(pool_t* pool, handle_t handle);
 void* pool_at_index(pool_t* pool, u32 index);
 
+// O(1), pushes the element onto the free list and bumps its generation
 void pool_free(pool_t* pool, handle_t handle);
 
 // resets all the elements to 0 (including generations)
@@ -142,14 +209,103 @@ typedef struct pool_iter_t {
 
 bool pool_iter(pool_t* pool, pool_iter_t* iter);
 
+// a run of consecutive in-use elements
+// data can be indexed directly as an array of count elements
+typedef struct pool_run_t {
+    void* data;
+    u32 start; // absolute index of the first element in the run
+    u32 count;
+} pool_run_t;
+
+typedef struct pool_run_iter_t {
+    // where to start searching from, set before iterating to skip reserved elements
+    u32 absolute_index;
+    pool_run_t run;
+} pool_run_iter_t;
+
+// iterates over the pool one run of in-use elements at a time
+// elements freed while iterating are fine, the current run is not updated though
+bool pool_iter_runs(pool_t* pool, pool_run_iter_t* iter);
+
+// handle of the element at an absolute index, for use with pool_iter_runs
+handle_t pool_handle_at_index(pool_t* pool, u32 index);
+
+// DENSE POOLS
+// a pool that keeps all its live elements packed at the front of data,
+// so systems can loop over them with a plain for(i < count).
+// freeing swaps the last element into the hole, so elements DO move around.
+// handles go through the slots array to find where their element currently lives,
+// so they stay valid until the element is freed. pointers dont.
+typedef struct dense_slot_t {
+    handle_t handle;
+    // where the element lives in data, or the next free slot when the slot is free
+    u32 dense_index;
+    pool_element_state_t state;
+} dense_slot_t;
+
+typedef struct dense_pool_t {
+    u32 element_size;
+
+    u32 count; // live elements, packed into [0, count)
+    u32 capacity; // in number of elements
+    u32 first_free_slot;
+    expand_type_t type;
+
+    void* data;
+    // which slot owns each packed element
+    u32* dense_to_sparse;
+    dense_slot_t* slots;
+} dense_pool_t;
+
+// number of bytes a block passed to dense_pool_new needs
+usize dense_pool_block_size(u32 capacity, u32 element_size);
+
+// immutable dense pool creation
+dense_pool_t dense_pool_new(void* block, u32 capacity, u32 element_size);
+dense_pool_t dense_pool_alloc_new(u32 capacity, u32 element_size);
+
+// expandable dense pool creation
+dense_pool_t dense_pool_alloc_new_expand(u32 capacity, u32 element_size, expand_type_t expand_type);
+
+// only grows, shrinking would invalidate handles
+void dense_pool_prepare(dense_pool_t* pool, u32 num_new_elements);
+
+// always appends to the end of the packed elements
+void* dense_pool_push(dense_pool_t* pool, handle_t* out_handle);
+void* dense_pool_get(dense_pool_t* pool, handle_t handle);
+// index into the packed elements, NOT a handle index
+void* dense_pool_at(dense_pool_t* pool, u32 dense_index);
+handle_t dense_pool_handle_at(dense_pool_t* pool, u32 dense_index);
+
+// moves the last element into the freed spot
+// stale handles are ignored
+void dense_pool_free(dense_pool_t* pool, handle_t handle);
+
+// resets all the elements (including generations)
+void dense_pool_clear(dense_pool_t* pool);
+void dense_pool_destroy(dense_pool_t* pool);
+
 // ARENAS
 typedef struct arena_t {
     usize size;
-    usize capacity;
+    usize capacity; // for virtual arenas this is the committed size
     expand_type_t type;
     void* data;
+    // size of the reserved address space for virtual arenas, 0 otherwise
+    usize reserved;
+    // bytes skipped over to align pushes since the last clear
+    usize padding;
+
+    // stats, these survive clears
+    // peak size the arena ever reached
+    usize high_water;
+    // pushes that didnt fit in the capacity at the time, whether the arena managed to grow or not
+    u32 overflows;
 } arena_t;
 
+// virtual arenas commit pages in chunks of at least this much
+enum { ARENA_COMMIT_GRANULARITY = KILOBYTES(64) };
+
 // TODO(nix3l): subarena_new
 
 // immutable arena creation
@@ -160,12 +316,25 @@ arena_t arena_alloc_new(usize capacity);
 arena_t arena_new_expand(range_t block, expand_type_t expand_type);
 arena_t arena_alloc_new_expand(usize capacity, expand_type_t expand_type);
 
+// virtual arena creation
+// reserves address space up front and commits pages as the arena grows
+// the data never moves, so pointers into the arena stay valid when it expands
+// these are always auto-expanding, up to the reserved size
+arena_t arena_virtual_new(usize reserve_size, bool huge_pages);
+// same thing but inside a block that is already reserved (ie a slice of a bigger reservation)
+// the block must be page aligned, and the first `committed` bytes of it already committed
+// destroying these will release the block, so dont unless you own it
+arena_t arena_virtual_new_in(range_t reserved_block, usize committed);
+
 // only works on non-immutable arenas
 void arena_resize(arena_t* arena, usize new_capacity);
 // only works on non-immutable arenas
 void arena_prepare(arena_t* arena, usize bytes);
 
 void* arena_push(arena_t* arena, u32 bytes);
+// alignment has to be a power of two
+// the skipped bytes get added to arena->padding
+void* arena_push_aligned(arena_t* arena, u32 bytes, u32 alignment);
 void* arena_push_to_capacity(arena_t* arena);
 
 void arena_pop(arena_t* arena, u32 bytes);
@@ -181,6 +350,10 @@ range_t arena_range_remaining(arena_t* arena);
 range_t arena_range_full(arena_t* arena);
 // allocates a range in an arena
 range_t arena_range_push(arena_t* arena, u32 bytes);
+range_t arena_range_push_aligned(arena_t* arena, u32 bytes, u32 alignment);
+
+// NOTE(nix3l): the containers below always start on a cache line,
+// so their data can be used with aligned simd loads and never shares a line with whatever was pushed before
 
 // allocates an immutable vector in the arena
 vector_t arena_vector_push(arena_t* arena, u32 num_elements, u32 element_size);
@@ -188,11 +361,167 @@ vector_t arena_vector_push(arena_t* arena, u32 num_elements, u32 element_size);
 // allocates an immutable pool in the arena
 pool_t arena_pool_push(arena_t* arena, u32 capacity, u32 element_size);
 
+// allocates an immutable dense pool in the arena
+dense_pool_t arena_dense_pool_push(arena_t* arena, u32 capacity, u32 element_size);
+
 // resets the arena head to zero
 void arena_clear(arena_t* arena);
 // frees the arena
 void arena_destroy(arena_t* arena);
 
+// TEMPORARY ARENA SCOPES
+// saves the arena head so everything pushed after it can be popped in one go
+typedef struct arena_temp_t {
+    arena_t* arena;
+    usize size;
+    usize padding;
+} arena_temp_t;
+
+arena_temp_t arena_temp_begin(arena_t* arena);
+// resets the arena head back to where it was at arena_temp_begin
+void arena_temp_end(arena_temp_t temp);
+
+// SCRATCH ARENAS
+// each thread gets a couple of scratch arenas for throwaway memory
+// they are allocated the first time a thread asks for one, and reused after that
+enum {
+    SCRATCH_ARENA_COUNT = 2,
+    SCRATCH_ARENA_SIZE = MEGABYTES(1),
+};
+
+// begins a temp scope in one of this thread's scratch arenas
+// pass in any arenas you are already pushing into (ie other scratch arenas further up the stack)
+// so you dont get handed the same one and stomp over your own memory
+// always end it with scratch_end
+arena_temp_t scratch_begin(arena_t** conflicts, u32 num_conflicts);
+void scratch_end(arena_temp_t scratch);
+
+// frees the calling thread's scratch arenas
+void scratch_release();
+
+// FRAME ARENAS
+// a ring of arenas, one for each frame in flight
+// memory pushed during a frame stays valid for `latency` frames, then that arena gets cleared and reused
+// so data the gpu is still reading (or things waiting to be destroyed) can outlive the frame it was made in
+// each frame gets its own slice of reserved address space with the budget committed up front
+// going over the budget commits more pages and gets counted in the stats, it doesnt fail
+enum {
+    FRAME_ARENA_MAX_LATENCY = 4,
+    FRAME_ARENA_RESERVE = MEGABYTES(64),
+};
+
+typedef struct frame_arena_t {
+    // number of frames memory lives for, also the number of arenas in the ring
+    u32 latency;
+    // arena in the ring that this frame pushes into
+    u32 current;
+    // frames since the ring was created
+    u64 frame;
+    usize budget; // per frame
+    arena_t arenas[FRAME_ARENA_MAX_LATENCY];
+
+    // stats, these are updated when a frame ends
+    // most any single frame used
+    usize high_water;
+    // frames that went over the budget
+    u32 overflows;
+} frame_arena_t;
+
+frame_arena_t frame_arena_new(u32 latency, usize frame_budget);
+
+// the arena for this frame, for passing into anything that takes an arena_t
+// whatever is pushed into it is good until frame_arena_advance has been called `latency` times
+arena_t* frame_arena_current(frame_arena_t* frames);
+// these panic instead of returning NULL if the frame runs out of reserved space
+void* frame_arena_push(frame_arena_t* frames, u32 bytes);
+void* frame_arena_push_aligned(frame_arena_t* frames, u32 bytes, u32 alignment);
+
+// ends the frame and moves on to the oldest arena in the ring, clearing it
+void frame_arena_advance(frame_arena_t* frames);
+void frame_arena_destroy(frame_arena_t* frames);
+
+// HASH MAPS
+// open addressing with robin hood probing (linear probing, but entries far from their home slot
+// get to kick out entries that are closer to theirs, which keeps every probe sequence short)
+// keys and values are copied in and stored inline, in their own arrays
+// NOTE(nix3l): the map fills up to 7/8 of its slots, the capacity passed in is how many entries
+// you want to fit, the actual slot count gets rounded up from that
+
+// pass as the key_size for maps keyed by nul terminated strings
+// the map stores the char pointer, NOT a copy of the string, so keep it alive while its in the map
+#define HASHMAP_STRING_KEY (0)
+
+typedef struct hashmap_t {
+    u32 size; // in entries
+    u32 capacity; // in slots, always a power of two
+    u32 key_size;
+    u32 value_size;
+    bool string_keys;
+
+    expand_type_t type;
+    // where bigger blocks come from when the map grows, NULL for the heap
+    arena_t* arena;
+
+    // 0 means the slot is empty, filled slots always have the top bit set
+    u32* hashes;
+    void* keys;
+    void* values;
+} hashmap_t;
+
+// size of the block needed for a map that fits capacity entries
+usize hashmap_block_size(u32 capacity, u32 key_size, u32 value_size);
+
+// immutable hash map creation
+hashmap_t hashmap_new(void* block, u32 capacity, u32 key_size, u32 value_size);
+hashmap_t hashmap_alloc_new(u32 capacity, u32 key_size, u32 value_size);
+
+// expandable hash map creation
+hashmap_t hashmap_alloc_new_expand(u32 capacity, u32 key_size, u32 value_size, expand_type_t expand_type);
+
+// allocates an immutable hash map in the arena
+hashmap_t arena_hashmap_push(arena_t* arena, u32 capacity, u32 key_size, u32 value_size);
+// allocates an auto-expanding hash map in the arena
+// growing pushes a new block and leaves the old one in the arena until it gets cleared
+hashmap_t arena_hashmap_push_expand(arena_t* arena, u32 capacity, u32 key_size, u32 value_size);
+
+// makes sure the map can hold capacity entries without growing again
+// only works on non-immutable maps, rehashes everything
+void hashmap_reserve(hashmap_t* map, u32 capacity);
+
+// key points to the key data (for string maps, a pointer to the char pointer)
+// returns a pointer to the value, or NULL if the key isnt in the map
+void* hashmap_get(hashmap_t* map, const void* key);
+// inserts the key or overwrites its value if it exists already
+// copies the value if its not NULL, otherwise new values are zeroed and existing ones left alone
+// returns a pointer to the value in the map, or NULL if the map is full and cant grow
+// NOTE(nix3l): pointers into the map are only good until the next put/remove
+void* hashmap_put(hashmap_t* map, const void* key, const void* value);
+// returns false if the key wasnt in the map
+bool hashmap_remove(hashmap_t* map, const void* key);
+
+// helpers so you dont have to take the address of the key yourself
+void* hashmap_get_u64(hashmap_t* map, u64 key);
+void* hashmap_put_u64(hashmap_t* map, u64 key, const void* value);
+bool hashmap_remove_u64(hashmap_t* map, u64 key);
+
+void* hashmap_get_str(hashmap_t* map, const char* key);
+void* hashmap_put_str(hashmap_t* map, const char* key, const void* value);
+bool hashmap_remove_str(hashmap_t* map, const char* key);
+
+// removes every entry but keeps the memory
+void hashmap_clear(hashmap_t* map);
+// frees heap maps, arena maps just get reset
+// like the other containers, dont call this on maps made over your own block with hashmap_new
+void hashmap_destroy(hashmap_t* map);
+
+typedef struct hashmap_iter_t {
+    u32 absolute_index;
+    void* key;
+    void* value;
+} hashmap_iter_t;
+
+bool hashmap_iter(hashmap_t* map, hashmap_iter_t* iter);
+
 typedef struct llist_node_t {
     void* data;
     struct llist_node_t* next;
@@ -222,4 +551,44 @@ typedef struct llist_iter_t {
 
 bool llist_iter(llist_t* list, llist_iter_t* iter);
 
+// CHUNKED LISTS
+// a list of fixed size chunks, each holding a bunch of elements inline
+// pushing only touches the arena once per chunk, and iterating walks contiguous memory
+// instead of chasing a pointer per element
+// chunks come from the arena passed to clist_push, so they live as long as the arena does
+typedef struct clist_chunk_t {
+    struct clist_chunk_t* next;
+    u32 count;
+    // elements come right after, see clist_chunk_data
+} clist_chunk_t;
+
+typedef struct clist_t {
+    u32 size; // in elements
+    u32 element_size;
+    u32 chunk_capacity; // elements per chunk
+    clist_chunk_t* first;
+    clist_chunk_t* last;
+} clist_t;
+
+clist_t clist_new(u32 element_size, u32 chunk_capacity);
+
+void* clist_chunk_data(clist_chunk_t* chunk);
+
+// returns a pointer to the new element, which is left as is
+void* clist_push(clist_t* list, arena_t* arena);
+// copies the data into the list, returns a pointer to the copy
+void* clist_push_data(clist_t* list, arena_t* arena, void* data);
+
+// does not deallocate the chunks
+void clist_clear(clist_t* list);
+
+typedef struct clist_iter_t {
+    u32 index;
+    void* data;
+    clist_chunk_t* chunk;
+    u32 chunk_index;
+} clist_iter_t;
+
+bool clist_iter(clist_t* list, clist_iter_t* iter);
+
 #endif
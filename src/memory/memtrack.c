@@ -0,0 +1,316 @@
+#if defined(MEMORY_TRACK_ALLOCS)
+
+#include "memtrack.h"
+#include "memory.h"
+#include "util/util.h"
+
+#include <stdatomic.h>
+
+// LIVE TABLE
+// open addressing on the pointer, slots get claimed with a cas
+// a live pointer is only ever in the table once (the allocator cant hand it out twice),
+// and only the thread freeing it removes it, so nothing else ever races on the same slot
+#define MEMTRACK_EMPTY (0)
+#define MEMTRACK_TOMBSTONE (1)
+
+typedef struct memtrack_entry_t {
+    _Atomic usize ptr;
+    usize size;
+    u32 site;
+    u32 frame;
+} memtrack_entry_t;
+
+// CALL SITES
+// keyed by a hash of file:line, claimed the same way
+typedef struct memtrack_site_slot_t {
+    _Atomic u64 key;
+    // written by whoever claims the slot, right after the key
+    // only the reports read these, and those run once everything is done allocating
+    const char* file;
+    u32 line;
+
+    _Atomic u64 allocations;
+    _Atomic u64 frees;
+    _Atomic u64 total_bytes;
+    _Atomic usize live_bytes;
+    _Atomic u32 last_frame;
+} memtrack_site_slot_t;
+
+#define MEMTRACK_NO_SITE (0xFFFFFFFF)
+
+static memtrack_entry_t memtrack_live[MEMTRACK_MAX_LIVE];
+static memtrack_site_slot_t memtrack_sites[MEMTRACK_MAX_SITES];
+
+static _Atomic u32 memtrack_frame = 0;
+static _Atomic u32 memtrack_frame_allocations = 0;
+static _Atomic u32 memtrack_frame_frees = 0;
+static _Atomic usize memtrack_frame_bytes = 0;
+
+static memtrack_frame_t memtrack_last = {0};
+static u32 memtrack_noisy = 0;
+// allocations that didnt fit in the live table
+static _Atomic u32 memtrack_dropped = 0;
+
+static u64 memtrack_mix(u64 x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static u32 memtrack_find_site(const char* file, u32 line) {
+    // never 0, thats the empty key
+    u64 key = memtrack_mix((u64) (usize) file ^ ((u64) line << 48)) | 1;
+
+    u32 index = key & (MEMTRACK_MAX_SITES - 1);
+    for(u32 i = 0; i < MEMTRACK_MAX_SITES; i ++) {
+        memtrack_site_slot_t* slot = &memtrack_sites[index];
+
+        u64 current = atomic_load_explicit(&slot->key, memory_order_acquire);
+        if(current == key) return index;
+
+        if(current == 0) {
+            // if two threads race for the slot with different keys, the loser just moves on
+            u64 expected = 0;
+            if(atomic_compare_exchange_strong_explicit(&slot->key, &expected, key, memory_order_acq_rel, memory_order_acquire)) {
+                slot->file = file;
+                slot->line = line;
+                return index;
+            }
+
+            if(expected == key) return index;
+        }
+
+        index = (index + 1) & (MEMTRACK_MAX_SITES - 1);
+    }
+
+    return MEMTRACK_NO_SITE;
+}
+
+static void memtrack_insert(void* ptr, usize size, u32 site, u32 frame) {
+    usize key = (usize) ptr;
+    u32 index = memtrack_mix(key) & (MEMTRACK_MAX_LIVE - 1);
+
+    for(u32 i = 0; i < MEMTRACK_MAX_LIVE; i ++) {
+        memtrack_entry_t* entry = &memtrack_live[index];
+
+        usize current = atomic_load_explicit(&entry->ptr, memory_order_relaxed);
+        if(current == MEMTRACK_EMPTY || current == MEMTRACK_TOMBSTONE) {
+            if(atomic_compare_exchange_strong_explicit(&entry->ptr, &current, key, memory_order_acquire, memory_order_relaxed)) {
+                entry->size = size;
+                entry->site = site;
+                entry->frame = frame;
+                return;
+            }
+        }
+
+        index = (index + 1) & (MEMTRACK_MAX_LIVE - 1);
+    }
+
+    atomic_fetch_add_explicit(&memtrack_dropped, 1, memory_order_relaxed);
+}
+
+// returns the entry for ptr, or NULL if it isnt in the table
+static memtrack_entry_t* memtrack_find(void* ptr) {
+    usize key = (usize) ptr;
+    u32 index = memtrack_mix(key) & (MEMTRACK_MAX_LIVE - 1);
+
+    for(u32 i = 0; i < MEMTRACK_MAX_LIVE; i ++) {
+        memtrack_entry_t* entry = &memtrack_live[index];
+
+        usize current = atomic_load_explicit(&entry->ptr, memory_order_acquire);
+        if(current == key) return entry;
+        if(current == MEMTRACK_EMPTY) return NULL;
+
+        index = (index + 1) & (MEMTRACK_MAX_LIVE - 1);
+    }
+
+    return NULL;
+}
+
+static void memtrack_record_alloc(void* ptr, usize bytes, const char* file, u32 line) {
+    u32 frame = atomic_load_explicit(&memtrack_frame, memory_order_relaxed);
+    atomic_fetch_add_explicit(&memtrack_frame_allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&memtrack_frame_bytes, bytes, memory_order_relaxed);
+
+    u32 site = memtrack_find_site(file, line);
+    if(site != MEMTRACK_NO_SITE) {
+        memtrack_site_slot_t* slot = &memtrack_sites[site];
+        atomic_fetch_add_explicit(&slot->allocations, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&slot->total_bytes, bytes, memory_order_relaxed);
+        atomic_fetch_add_explicit(&slot->live_bytes, bytes, memory_order_relaxed);
+        atomic_store_explicit(&slot->last_frame, frame, memory_order_relaxed);
+    }
+
+    memtrack_insert(ptr, bytes, site, frame);
+}
+
+// pulls ptr out of the live table, handing back what it was recorded with
+// has to happen before the memory goes back to the allocator, or another thread could get
+// the same address back and insert it again while the old entry is still there
+static bool memtrack_take(void* ptr, const char* file, u32 line, memtrack_entry_t* out) {
+    memtrack_entry_t* entry = memtrack_find(ptr);
+    if(!entry) {
+        // either it got dropped from a full table, or it never came from mem_alloc
+        if(atomic_load_explicit(&memtrack_dropped, memory_order_relaxed) == 0)
+            LOG_WARN("freeing untracked pointer [%p] at [%s:%u]\n", ptr, file, line);
+        return false;
+    }
+
+    out->size = entry->size;
+    out->site = entry->site;
+    out->frame = entry->frame;
+    atomic_store_explicit(&entry->ptr, MEMTRACK_TOMBSTONE, memory_order_release);
+    return true;
+}
+
+static void memtrack_record_free(memtrack_entry_t* taken) {
+    atomic_fetch_add_explicit(&memtrack_frame_frees, 1, memory_order_relaxed);
+
+    if(taken && taken->site != MEMTRACK_NO_SITE) {
+        memtrack_site_slot_t* slot = &memtrack_sites[taken->site];
+        atomic_fetch_add_explicit(&slot->frees, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&slot->live_bytes, taken->size, memory_order_relaxed);
+    }
+}
+
+void* memtrack_alloc(usize bytes, const char* file, u32 line) {
+    void* ptr = mem_raw_alloc(bytes);
+    if(ptr) memtrack_record_alloc(ptr, bytes, file, line);
+    return ptr;
+}
+
+void* memtrack_calloc(usize bytes, const char* file, u32 line) {
+    void* ptr = mem_raw_calloc(bytes);
+    if(ptr) memtrack_record_alloc(ptr, bytes, file, line);
+    return ptr;
+}
+
+void* memtrack_realloc(void* ptr, usize bytes, const char* file, u32 line) {
+    memtrack_entry_t taken = {0};
+    bool tracked = ptr && memtrack_take(ptr, file, line, &taken);
+
+    void* new_ptr = mem_raw_realloc(ptr, bytes);
+    // a failed realloc leaves the old allocation alone, so it goes back in as it was
+    if(!new_ptr && bytes > 0) {
+        if(tracked) memtrack_insert(ptr, taken.size, taken.site, taken.frame);
+        return NULL;
+    }
+
+    if(ptr) memtrack_record_free(tracked ? &taken : NULL);
+    if(new_ptr) memtrack_record_alloc(new_ptr, bytes, file, line);
+    return new_ptr;
+}
+
+void memtrack_free(void* ptr, const char* file, u32 line) {
+    if(!ptr) return;
+
+    memtrack_entry_t taken = {0};
+    bool tracked = memtrack_take(ptr, file, line, &taken);
+    memtrack_record_free(tracked ? &taken : NULL);
+    mem_raw_free(ptr);
+}
+
+u32 memtrack_get_sites(memtrack_site_t* out, u32 max_sites) {
+    u32 count = 0;
+    for(u32 i = 0; i < MEMTRACK_MAX_SITES; i ++) {
+        memtrack_site_slot_t* slot = &memtrack_sites[i];
+        if(atomic_load_explicit(&slot->key, memory_order_acquire) == 0) continue;
+
+        if(count < max_sites) {
+            out[count] = (memtrack_site_t) {
+                .file = slot->file,
+                .line = slot->line,
+                .allocations = atomic_load_explicit(&slot->allocations, memory_order_relaxed),
+                .frees = atomic_load_explicit(&slot->frees, memory_order_relaxed),
+                .total_bytes = atomic_load_explicit(&slot->total_bytes, memory_order_relaxed),
+                .live_bytes = atomic_load_explicit(&slot->live_bytes, memory_order_relaxed),
+                .last_frame = atomic_load_explicit(&slot->last_frame, memory_order_relaxed),
+            };
+        }
+
+        count ++;
+    }
+
+    return count;
+}
+
+memtrack_frame_t memtrack_last_frame() {
+    return memtrack_last;
+}
+
+u32 memtrack_noisy_frames() {
+    return memtrack_noisy;
+}
+
+void memtrack_end_frame() {
+    u32 frame = atomic_fetch_add_explicit(&memtrack_frame, 1, memory_order_relaxed);
+
+    memtrack_last = (memtrack_frame_t) {
+        .frame = frame,
+        .allocations = atomic_exchange_explicit(&memtrack_frame_allocations, 0, memory_order_relaxed),
+        .frees = atomic_exchange_explicit(&memtrack_frame_frees, 0, memory_order_relaxed),
+        .bytes = atomic_exchange_explicit(&memtrack_frame_bytes, 0, memory_order_relaxed),
+    };
+
+    if(frame >= MEMTRACK_WARMUP_FRAMES && (memtrack_last.allocations || memtrack_last.frees))
+        memtrack_noisy ++;
+}
+
+void memtrack_report_sites() {
+    u32 frames = atomic_load_explicit(&memtrack_frame, memory_order_relaxed);
+    LOG("heap traffic over [%u] frames, [%u] of them after the first [%u] touched the heap\n",
+        frames, memtrack_noisy, MEMTRACK_WARMUP_FRAMES);
+
+    for(u32 i = 0; i < MEMTRACK_MAX_SITES; i ++) {
+        memtrack_site_slot_t* slot = &memtrack_sites[i];
+        if(atomic_load_explicit(&slot->key, memory_order_acquire) == 0) continue;
+
+        u64 allocations = atomic_load_explicit(&slot->allocations, memory_order_relaxed);
+        u64 frees = atomic_load_explicit(&slot->frees, memory_order_relaxed);
+        u64 total_bytes = atomic_load_explicit(&slot->total_bytes, memory_order_relaxed);
+        usize live_bytes = atomic_load_explicit(&slot->live_bytes, memory_order_relaxed);
+        u32 last_frame = atomic_load_explicit(&slot->last_frame, memory_order_relaxed);
+
+        LOG("[%s:%u] [%llu] allocations [%llu] frees, [%llu] bytes total, [%zu] live\n",
+            slot->file, slot->line, (unsigned long long) allocations, (unsigned long long) frees,
+            (unsigned long long) total_bytes, live_bytes);
+
+        if(last_frame >= MEMTRACK_WARMUP_FRAMES)
+            LOG_WARN("[%s:%u] still allocating in frame [%u]\n", slot->file, slot->line, last_frame);
+    }
+
+    u32 dropped = atomic_load_explicit(&memtrack_dropped, memory_order_relaxed);
+    if(dropped) LOG_WARN("[%u] allocations didnt fit in the live table (MEMTRACK_MAX_LIVE)\n", dropped);
+}
+
+u32 memtrack_report_live() {
+    u32 count = 0;
+    usize bytes = 0;
+
+    for(u32 i = 0; i < MEMTRACK_MAX_LIVE; i ++) {
+        memtrack_entry_t* entry = &memtrack_live[i];
+        usize ptr = atomic_load_explicit(&entry->ptr, memory_order_acquire);
+        if(ptr == MEMTRACK_EMPTY || ptr == MEMTRACK_TOMBSTONE) continue;
+
+        const char* file = "?";
+        u32 line = 0;
+        if(entry->site != MEMTRACK_NO_SITE) {
+            file = memtrack_sites[entry->site].file;
+            line = memtrack_sites[entry->site].line;
+        }
+
+        LOG_WARN("live allocation [%p] of [%zu] bytes from [%s:%u] in frame [%u]\n",
+                 (void*) ptr, entry->size, file, line, entry->frame);
+
+        count ++;
+        bytes += entry->size;
+    }
+
+    if(count) LOG_WARN("[%u] allocations still live, [%zu] bytes\n", count, bytes);
+    return count;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _MEMTRACK_H
+#define _MEMTRACK_H
+
+#include "base.h"
+
+// heap allocation tracker, sits in front of the mem_* macros when MEMORY_TRACK_ALLOCS is defined
+// (build with `make TRACK_ALLOCS=1`)
+// every allocation gets recorded with the file/line it came from, its size and the frame it was made in
+// live allocations go in a fixed size lock-free table keyed by pointer, and every call site gets
+// its own running totals, so allocating from any thread never takes a lock
+// NOTE(nix3l): mem_* calls inside the containers (vectors, pools...) show up as coming from memory.c
+
+enum {
+    // slots in the live allocation table, allocations past this still get counted but not listed
+    MEMTRACK_MAX_LIVE = 1 << 16,
+    // distinct file:line pairs that can be told apart
+    MEMTRACK_MAX_SITES = 1024,
+    // frames allowed to allocate before the heap is expected to go quiet
+    MEMTRACK_WARMUP_FRAMES = 8,
+};
+
+void* memtrack_alloc(usize bytes, const char* file, u32 line);
+void* memtrack_calloc(usize bytes, const char* file, u32 line);
+void* memtrack_realloc(void* ptr, usize bytes, const char* file, u32 line);
+void memtrack_free(void* ptr, const char* file, u32 line);
+
+// totals for everything allocated from one file:line
+typedef struct memtrack_site_t {
+    const char* file;
+    u32 line;
+
+    u64 allocations;
+    u64 frees; // of allocations made here, wherever they got freed
+    u64 total_bytes;
+    usize live_bytes;
+    // last frame anything got allocated here
+    u32 last_frame;
+} memtrack_site_t;
+
+// copies up to max_sites of the call sites into out, returns how many there were
+u32 memtrack_get_sites(memtrack_site_t* out, u32 max_sites);
+
+typedef struct memtrack_frame_t {
+    u32 frame;
+    u32 allocations; // includes reallocs
+    u32 frees;
+    usize bytes;
+} memtrack_frame_t;
+
+// counts for the last frame that ended
+memtrack_frame_t memtrack_last_frame();
+// frames past the warmup that touched the heap at all, should stay 0
+u32 memtrack_noisy_frames();
+
+// ends the frame, call once at the end of every frame
+void memtrack_end_frame();
+
+// logs every call site, and warns about the ones still allocating after the warmup
+void memtrack_report_sites();
+// logs every allocation that hasnt been freed yet, returns how many there were
+u32 memtrack_report_live();
+
+#endif
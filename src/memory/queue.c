@@ -0,0 +1,139 @@
+#include "queue.h"
+
+static u32 queue_round_capacity(u32 capacity) {
+    u32 rounded = 2;
+    while(rounded < capacity) rounded <<= 1;
+    return rounded;
+}
+
+// SINGLE PRODUCER SINGLE CONSUMER
+spsc_queue_t arena_spsc_queue_push(arena_t* arena, u32 capacity, u32 element_size) {
+    capacity = queue_round_capacity(capacity);
+
+    void* data = arena_push_aligned(arena, capacity * element_size, CACHE_LINE_SIZE);
+    if(!data) PANIC("couldnt push enough memory for spsc queue in arena\n");
+
+    spsc_queue_t queue = {
+        .cached_tail = 0,
+        .cached_head = 0,
+        .capacity = capacity,
+        .mask = capacity - 1,
+        .element_size = element_size,
+        .data = data,
+    };
+
+    atomic_init(&queue.head, 0);
+    atomic_init(&queue.tail, 0);
+    return queue;
+}
+
+bool spsc_queue_push(spsc_queue_t* queue, const void* element) {
+    u32 tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    if(tail - queue->cached_head == queue->capacity) {
+        queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if(tail - queue->cached_head == queue->capacity) return false;
+    }
+
+    memcpy(queue->data + (tail & queue->mask) * queue->element_size, element, queue->element_size);
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool spsc_queue_pop(spsc_queue_t* queue, void* out) {
+    u32 head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    if(head == queue->cached_tail) {
+        queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if(head == queue->cached_tail) return false;
+    }
+
+    memcpy(out, queue->data + (head & queue->mask) * queue->element_size, queue->element_size);
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
+
+// MULTI PRODUCER MULTI CONSUMER
+// cells are laid out as [sequence][element], the element starts 8 bytes in
+#define MPMC_CELL_HEADER_SIZE (8)
+
+static _Atomic u32* mpmc_cell_sequence(mpmc_queue_t* queue, u32 pos) {
+    return queue->cells + (pos & queue->mask) * queue->cell_size;
+}
+
+static void* mpmc_cell_data(mpmc_queue_t* queue, u32 pos) {
+    return queue->cells + (pos & queue->mask) * queue->cell_size + MPMC_CELL_HEADER_SIZE;
+}
+
+mpmc_queue_t arena_mpmc_queue_push(arena_t* arena, u32 capacity, u32 element_size) {
+    capacity = queue_round_capacity(capacity);
+    u32 cell_size = ALIGN_UP(MPMC_CELL_HEADER_SIZE + element_size, 8);
+
+    void* cells = arena_push_aligned(arena, capacity * cell_size, CACHE_LINE_SIZE);
+    if(!cells) PANIC("couldnt push enough memory for mpmc queue in arena\n");
+
+    mpmc_queue_t queue = {
+        .capacity = capacity,
+        .mask = capacity - 1,
+        .element_size = element_size,
+        .cell_size = cell_size,
+        .cells = cells,
+    };
+
+    // cell i is ready to be written by whoever gets enqueue position i
+    for(u32 i = 0; i < capacity; i ++) atomic_init(mpmc_cell_sequence(&queue, i), i);
+
+    atomic_init(&queue.enqueue_pos, 0);
+    atomic_init(&queue.dequeue_pos, 0);
+    return queue;
+}
+
+bool mpmc_queue_push(mpmc_queue_t* queue, const void* element) {
+    u32 pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+
+    for(;;) {
+        u32 seq = atomic_load_explicit(mpmc_cell_sequence(queue, pos), memory_order_acquire);
+        i32 diff = (i32) (seq - pos);
+
+        if(diff == 0) {
+            // the cell is free for this position, try to claim it
+            // on failure pos gets updated to the current value, so just go again
+            if(atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if(diff < 0) {
+            // the consumer for the last lap hasnt gotten to this cell yet, so the queue is full
+            return false;
+        } else {
+            // someone else claimed this position already
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    memcpy(mpmc_cell_data(queue, pos), element, queue->element_size);
+    atomic_store_explicit(mpmc_cell_sequence(queue, pos), pos + 1, memory_order_release);
+    return true;
+}
+
+bool mpmc_queue_pop(mpmc_queue_t* queue, void* out) {
+    u32 pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+
+    for(;;) {
+        u32 seq = atomic_load_explicit(mpmc_cell_sequence(queue, pos), memory_order_acquire);
+        i32 diff = (i32) (seq - (pos + 1));
+
+        if(diff == 0) {
+            if(atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if(diff < 0) {
+            // nothing has been written here yet, so the queue is empty
+            return false;
+        } else {
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    memcpy(out, mpmc_cell_data(queue, pos), queue->element_size);
+    // free the cell up for the producer one lap ahead
+    atomic_store_explicit(mpmc_cell_sequence(queue, pos), pos + queue->capacity, memory_order_release);
+    return true;
+}
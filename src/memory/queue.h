@@ -0,0 +1,64 @@
+#ifndef _QUEUE_H
+#define _QUEUE_H
+
+#include "base.h"
+#include "memory.h"
+
+#include <stdatomic.h>
+
+// bounded lock-free ring queues for passing data between threads
+// elements are copied in and out, both queues live in memory pushed from an arena
+// the capacity gets rounded up to a power of two
+// NOTE(nix3l): these hold atomics, so dont copy a queue once threads have started using it
+
+// SINGLE PRODUCER SINGLE CONSUMER
+// exactly one thread pushes and exactly one (other) thread pops
+// each side keeps a cached copy of the other sides index so it only has to touch
+// the other sides cache line when the queue looks full/empty
+typedef struct spsc_queue_t {
+    // consumer side
+    _Alignas(CACHE_LINE_SIZE) _Atomic u32 head;
+    u32 cached_tail;
+
+    // producer side
+    _Alignas(CACHE_LINE_SIZE) _Atomic u32 tail;
+    u32 cached_head;
+
+    // read only after creation
+    _Alignas(CACHE_LINE_SIZE) u32 capacity;
+    u32 mask;
+    u32 element_size;
+    void* data;
+} spsc_queue_t;
+
+spsc_queue_t arena_spsc_queue_push(arena_t* arena, u32 capacity, u32 element_size);
+
+// returns false if the queue is full
+bool spsc_queue_push(spsc_queue_t* queue, const void* element);
+// copies the element into out, returns false if the queue is empty
+bool spsc_queue_pop(spsc_queue_t* queue, void* out);
+
+// MULTI PRODUCER MULTI CONSUMER
+// any number of threads can push and pop
+// dmitry vyukov's bounded queue: every cell has a sequence number saying whose turn it is,
+// so producers and consumers only fight over their own position counter
+typedef struct mpmc_queue_t {
+    _Alignas(CACHE_LINE_SIZE) _Atomic u32 enqueue_pos;
+    _Alignas(CACHE_LINE_SIZE) _Atomic u32 dequeue_pos;
+
+    // read only after creation
+    _Alignas(CACHE_LINE_SIZE) u32 capacity;
+    u32 mask;
+    u32 element_size;
+    u32 cell_size;
+    void* cells;
+} mpmc_queue_t;
+
+mpmc_queue_t arena_mpmc_queue_push(arena_t* arena, u32 capacity, u32 element_size);
+
+// returns false if the queue is full
+bool mpmc_queue_push(mpmc_queue_t* queue, const void* element);
+// copies the element into out, returns false if the queue is empty
+bool mpmc_queue_pop(mpmc_queue_t* queue, void* out);
+
+#endif
@@ -0,0 +1,313 @@
+#include "slab.h"
+#include "platform/platform.h"
+
+#include <stdatomic.h>
+
+// every block starts with a header, which keeps the returned memory 16 byte aligned
+// free blocks reuse the start of the header as the free list link
+typedef struct slab_header_t {
+    u32 size_class;
+    u32 magic;
+    usize size; // what was asked for
+} slab_header_t;
+
+#define SLAB_HEADER_SIZE (16)
+_Static_assert(sizeof(slab_header_t) <= SLAB_HEADER_SIZE && SLAB_HEADER_SIZE % 16 == 0,
+               "slab_header_t doesnt fit in SLAB_HEADER_SIZE, or it stopped being a multiple of 16");
+#define SLAB_MAGIC (0x51AB51AB)
+// size class for allocations that got their own mapping
+#define SLAB_CLASS_LARGE (0xFFFFFFFF)
+
+// per thread free lists, no locking needed
+// fresh chunks get handed out a block at a time off the bump pointer, blocks only
+// ever end up in a list once theyve been freed
+typedef struct slab_cache_t {
+    void* head[SLAB_NUM_CLASSES];
+    u32 count[SLAB_NUM_CLASSES];
+    void* bump[SLAB_NUM_CLASSES];
+    void* bump_end[SLAB_NUM_CLASSES];
+} slab_cache_t;
+
+// shared free lists, each on its own cache line so threads working on different sizes dont fight
+typedef struct slab_depot_t {
+    _Alignas(CACHE_LINE_SIZE) atomic_flag lock;
+    void* head;
+    u32 count;
+} slab_depot_t;
+
+// stats get counted per thread and added to the shared totals whenever the thread has
+// to touch shared state anyway (refills, spills, big allocations), so the fast path stays atomic-free
+// the deltas can go negative when a thread frees memory another one allocated, unsigned wraparound sorts that out
+typedef struct slab_pending_stats_t {
+    usize live_bytes;
+    usize used_bytes;
+    usize carved_bytes;
+    u64 live_allocations;
+    u64 total_allocations;
+} slab_pending_stats_t;
+
+static THREAD_LOCAL slab_cache_t slab_cache = {0};
+static THREAD_LOCAL slab_pending_stats_t slab_pending = {0};
+static slab_depot_t slab_depots[SLAB_NUM_CLASSES] = {0};
+
+static _Atomic usize slab_live_bytes = 0;
+static _Atomic usize slab_used_bytes = 0;
+static _Atomic usize slab_carved_bytes = 0;
+static _Atomic usize slab_committed_bytes = 0;
+static _Atomic u64 slab_live_allocations = 0;
+static _Atomic u64 slab_total_allocations = 0;
+
+static u32 slab_class_for(usize bytes) {
+    if(bytes <= 128) return bytes ? (bytes - 1) >> 4 : 0;
+
+    // bytes is in (2^log, 2^(log + 1)], split that into quarters
+    u32 log = 63 - CLZ64(bytes - 1);
+    u32 quarter = ((bytes - 1) >> (log - 2)) & 3;
+    return 8 + (log - 7) * 4 + quarter;
+}
+
+static usize slab_class_size(u32 size_class) {
+    if(size_class < 8) return (size_class + 1) << 4;
+
+    u32 log = 7 + (size_class - 8) / 4;
+    u32 quarter = (size_class - 8) % 4;
+    return ((usize) 1 << log) + (quarter + 1) * ((usize) 1 << (log - 2));
+}
+
+static usize slab_large_mapping_size(usize bytes) {
+    return ALIGN_UP(bytes + SLAB_HEADER_SIZE, platform_page_size());
+}
+
+static void slab_flush_stats() {
+    atomic_fetch_add_explicit(&slab_live_bytes, slab_pending.live_bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slab_used_bytes, slab_pending.used_bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slab_carved_bytes, slab_pending.carved_bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slab_live_allocations, slab_pending.live_allocations, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slab_total_allocations, slab_pending.total_allocations, memory_order_relaxed);
+    slab_pending = (slab_pending_stats_t) {0};
+}
+
+static void slab_depot_lock(slab_depot_t* depot) {
+    while(atomic_flag_test_and_set_explicit(&depot->lock, memory_order_acquire));
+}
+
+static void slab_depot_unlock(slab_depot_t* depot) {
+    atomic_flag_clear_explicit(&depot->lock, memory_order_release);
+}
+
+// gives this thread a fresh chunk to bump allocate out of
+// nothing in it gets touched until its handed out, so the pages only fault in as theyre used
+static void slab_new_chunk(u32 size_class) {
+    void* chunk = platform_mem_reserve(SLAB_CHUNK_SIZE);
+    if(!chunk || !platform_mem_commit(chunk, SLAB_CHUNK_SIZE)) PANIC("slab allocator ran out of memory\n");
+    atomic_fetch_add_explicit(&slab_committed_bytes, SLAB_CHUNK_SIZE, memory_order_relaxed);
+
+    usize stride = SLAB_HEADER_SIZE + slab_class_size(size_class);
+    slab_cache.bump[size_class] = chunk;
+    slab_cache.bump_end[size_class] = chunk + (SLAB_CHUNK_SIZE / stride) * stride;
+}
+
+static void* slab_bump(u32 size_class) {
+    void* block = slab_cache.bump[size_class];
+    if(block == slab_cache.bump_end[size_class]) return NULL;
+
+    usize stride = SLAB_HEADER_SIZE + slab_class_size(size_class);
+    slab_cache.bump[size_class] += stride;
+    slab_pending.carved_bytes += stride;
+    return block;
+}
+
+static void slab_refill(u32 size_class) {
+    slab_depot_t* depot = &slab_depots[size_class];
+    slab_flush_stats();
+
+    slab_depot_lock(depot);
+    for(u32 i = 0; i < SLAB_BATCH && depot->head; i ++) {
+        void* block = depot->head;
+        depot->head = *(void**) block;
+        depot->count --;
+
+        *(void**) block = slab_cache.head[size_class];
+        slab_cache.head[size_class] = block;
+        slab_cache.count[size_class] ++;
+    }
+    slab_depot_unlock(depot);
+}
+
+// moves count blocks from this thread's cache to the shared list
+static void slab_spill(u32 size_class, u32 count) {
+    slab_depot_t* depot = &slab_depots[size_class];
+    slab_flush_stats();
+
+    slab_depot_lock(depot);
+    for(u32 i = 0; i < count && slab_cache.head[size_class]; i ++) {
+        void* block = slab_cache.head[size_class];
+        slab_cache.head[size_class] = *(void**) block;
+        slab_cache.count[size_class] --;
+
+        *(void**) block = depot->head;
+        depot->head = block;
+        depot->count ++;
+    }
+    slab_depot_unlock(depot);
+}
+
+static void slab_track_alloc(usize bytes, usize used) {
+    slab_pending.live_bytes += bytes;
+    slab_pending.used_bytes += used;
+    slab_pending.live_allocations ++;
+    slab_pending.total_allocations ++;
+}
+
+static void slab_track_free(usize bytes, usize used) {
+    slab_pending.live_bytes -= bytes;
+    slab_pending.used_bytes -= used;
+    slab_pending.live_allocations --;
+}
+
+static void* slab_alloc_large(usize bytes) {
+    usize mapping = slab_large_mapping_size(bytes);
+    void* block = platform_mem_reserve(mapping);
+    if(!block || !platform_mem_commit(block, mapping)) PANIC("slab allocator couldnt map [%zu] bytes\n", bytes);
+    atomic_fetch_add_explicit(&slab_committed_bytes, mapping, memory_order_relaxed);
+    slab_pending.carved_bytes += mapping;
+
+    slab_header_t* header = block;
+    header->size_class = SLAB_CLASS_LARGE;
+    header->magic = SLAB_MAGIC;
+    header->size = bytes;
+
+    slab_track_alloc(bytes, mapping);
+    slab_flush_stats();
+    return block + SLAB_HEADER_SIZE;
+}
+
+void* slab_alloc(usize bytes) {
+    if(bytes > SLAB_MAX_SIZE) return slab_alloc_large(bytes);
+
+    u32 size_class = slab_class_for(bytes);
+
+    // freed blocks first, then whats left of the current chunk, then other threads' spills,
+    // and only then a new chunk
+    void* block = NULL;
+    if(!slab_cache.head[size_class]) block = slab_bump(size_class);
+    if(!block) {
+        if(!slab_cache.head[size_class]) slab_refill(size_class);
+        if(!slab_cache.head[size_class]) {
+            slab_new_chunk(size_class);
+            block = slab_bump(size_class);
+        } else {
+            block = slab_cache.head[size_class];
+            slab_cache.head[size_class] = *(void**) block;
+            slab_cache.count[size_class] --;
+        }
+    }
+
+    slab_header_t* header = block;
+    header->size_class = size_class;
+    header->magic = SLAB_MAGIC;
+    header->size = bytes;
+
+    slab_track_alloc(bytes, SLAB_HEADER_SIZE + slab_class_size(size_class));
+    return block + SLAB_HEADER_SIZE;
+}
+
+void* slab_calloc(usize bytes) {
+    void* ptr = slab_alloc(bytes);
+    mem_clear(ptr, bytes);
+    return ptr;
+}
+
+static slab_header_t* slab_get_header(void* ptr) {
+    slab_header_t* header = ptr - SLAB_HEADER_SIZE;
+    if(header->magic != SLAB_MAGIC) PANIC("freeing memory that didnt come from the slab allocator (or got freed twice)\n");
+    return header;
+}
+
+void slab_free(void* ptr) {
+    if(!ptr) return;
+
+    slab_header_t* header = slab_get_header(ptr);
+    header->magic = 0;
+
+    if(header->size_class == SLAB_CLASS_LARGE) {
+        usize mapping = slab_large_mapping_size(header->size);
+        slab_track_free(header->size, mapping);
+        slab_pending.carved_bytes -= mapping;
+        slab_flush_stats();
+        atomic_fetch_sub_explicit(&slab_committed_bytes, mapping, memory_order_relaxed);
+        platform_mem_release(header, mapping);
+        return;
+    }
+
+    u32 size_class = header->size_class;
+    slab_track_free(header->size, SLAB_HEADER_SIZE + slab_class_size(size_class));
+
+    void* block = header;
+    *(void**) block = slab_cache.head[size_class];
+    slab_cache.head[size_class] = block;
+    slab_cache.count[size_class] ++;
+
+    // dont let one thread hoard everything it ever freed
+    if(slab_cache.count[size_class] > SLAB_BATCH * 2) slab_spill(size_class, SLAB_BATCH);
+}
+
+void* slab_realloc(void* ptr, usize bytes) {
+    if(!ptr) return slab_alloc(bytes);
+    if(bytes == 0) {
+        slab_free(ptr);
+        return NULL;
+    }
+
+    slab_header_t* header = slab_get_header(ptr);
+
+    usize capacity = header->size_class == SLAB_CLASS_LARGE
+        ? slab_large_mapping_size(header->size) - SLAB_HEADER_SIZE
+        : slab_class_size(header->size_class);
+
+    // still fits, just fix up the live byte count
+    // NOTE(nix3l): doesnt shrink into a smaller class, shrinking reallocs are rare enough in here
+    if(bytes <= capacity) {
+        if(header->size_class != SLAB_CLASS_LARGE || slab_large_mapping_size(bytes) == slab_large_mapping_size(header->size)) {
+            slab_pending.live_bytes += bytes - header->size;
+            header->size = bytes;
+            return ptr;
+        }
+    }
+
+    void* new_ptr = slab_alloc(bytes);
+    memcpy(new_ptr, ptr, MIN(bytes, header->size));
+    slab_free(ptr);
+    return new_ptr;
+}
+
+void slab_thread_flush() {
+    for(u32 i = 0; i < SLAB_NUM_CLASSES; i ++) {
+        // the rest of the chunk goes too, this is the one place its worth linking it all up
+        void* block;
+        while((block = slab_bump(i))) {
+            *(void**) block = slab_cache.head[i];
+            slab_cache.head[i] = block;
+            slab_cache.count[i] ++;
+        }
+
+        if(slab_cache.count[i] > 0) slab_spill(i, slab_cache.count[i]);
+    }
+
+    slab_flush_stats();
+}
+
+slab_stats_t slab_get_stats() {
+    slab_flush_stats();
+    slab_stats_t stats = {
+        .live_bytes = atomic_load_explicit(&slab_live_bytes, memory_order_relaxed),
+        .used_bytes = atomic_load_explicit(&slab_used_bytes, memory_order_relaxed),
+        .committed_bytes = atomic_load_explicit(&slab_committed_bytes, memory_order_relaxed),
+        .free_bytes = atomic_load_explicit(&slab_carved_bytes, memory_order_relaxed) - atomic_load_explicit(&slab_used_bytes, memory_order_relaxed),
+        .live_allocations = atomic_load_explicit(&slab_live_allocations, memory_order_relaxed),
+        .total_allocations = atomic_load_explicit(&slab_total_allocations, memory_order_relaxed),
+    };
+
+    if(stats.used_bytes > 0) stats.fragmentation = 1.0f - (f32) stats.live_bytes / stats.used_bytes;
+    return stats;
+}
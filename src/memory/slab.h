@@ -0,0 +1,56 @@
+#ifndef _SLAB_H
+#define _SLAB_H
+
+#include "base.h"
+
+// size-class slab allocator, sits behind the mem_* macros in memory.h
+// small allocations get rounded up to one of a fixed set of sizes, and each size gets carved
+// out of big chunks taken straight from the os. every thread keeps its own free lists,
+// so allocating/freeing is usually just popping/pushing a list without any locks
+// anything bigger than SLAB_MAX_SIZE gets its own mapping
+// NOTE(nix3l): define MEMORY_LIBC_ALLOC to skip all this and go straight to malloc/free
+
+enum {
+    SLAB_MAX_SIZE = KILOBYTES(32),
+    // 8 classes of 16 bytes up to 128, then 4 classes per power of two up to SLAB_MAX_SIZE
+    SLAB_NUM_CLASSES = 40,
+    // how much memory a thread takes at once when a size class runs out, blocks get handed out of it as needed
+    SLAB_CHUNK_SIZE = KILOBYTES(256),
+    // how many blocks move between a thread's cache and the shared lists at a time
+    SLAB_BATCH = 32,
+};
+
+void* slab_alloc(usize bytes);
+// zeroes the memory
+void* slab_calloc(usize bytes);
+// stays in place if the new size still fits in the same size class
+void* slab_realloc(void* ptr, usize bytes);
+void slab_free(void* ptr);
+
+// gives the blocks cached by the calling thread back to the shared lists
+// call before a thread exits, otherwise its cached blocks are stuck there
+void slab_thread_flush();
+
+typedef struct slab_stats_t {
+    // bytes asked for by live allocations
+    usize live_bytes;
+    // bytes taken up by live allocations, including headers and rounding up to the size class
+    usize used_bytes;
+    // everything taken from the os, whether its in use, sitting in a free list or not handed out yet
+    usize committed_bytes;
+    // freed blocks sitting in the per thread/shared free lists, waiting to be reused
+    usize free_bytes;
+
+    u64 live_allocations;
+    u64 total_allocations;
+
+    // internal waste, share of the memory held by live allocations that isnt holding their data
+    // (headers and rounding up to the size class), 1 - live_bytes / used_bytes
+    f32 fragmentation;
+} slab_stats_t;
+
+// NOTE(nix3l): threads only add their counts to the totals every so often,
+// so numbers from other threads can be behind by a batch or so
+slab_stats_t slab_get_stats();
+
+#endif
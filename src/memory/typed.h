@@ -0,0 +1,157 @@
+#ifndef _TYPED_H
+#define _TYPED_H
+
+#include "base.h"
+#include "memory.h"
+
+#include <stddef.h>
+
+// typed wrappers around vector_t and pool_t, generated per element type
+// the element size is known at compile time and the hot functions (get/push/remove) are static inline,
+// so loops over these can actually get inlined and vectorised
+//
+// the typed containers are a union with the untyped one and have the exact same layout,
+// so `.base` can be passed to any of the normal vector_*/pool_* functions, and a normal one
+// can be wrapped with _from. anything not wrapped here (iterators, resizing, destroying) goes through .base
+//
+// VECTOR_DEFINE(v2i) gives v2i_vector_t, v2i_vector_get, ...
+// for types that end in _t use the _NAMED version, ie POOL_DEFINE_NAMED(rigidbody_t, rigidbody)
+// gives rigidbody_pool_t, rigidbody_pool_get, ...
+//
+// NOTE(nix3l): the same type can only be defined once per translation unit,
+// so put the defines next to the type if more than one file needs it
+
+// TYPED VECTORS
+#define VECTOR_DEFINE(_type) VECTOR_DEFINE_NAMED(_type, _type)
+
+#define VECTOR_DEFINE_NAMED(_type, _name) \
+    typedef union _name##_vector_t { \
+        vector_t base; \
+        struct { \
+            u32 size; \
+            u32 capacity; \
+            u32 element_size; \
+            expand_type_t type; \
+            _type* data; \
+        }; \
+    } _name##_vector_t; \
+    \
+    _Static_assert(sizeof(_name##_vector_t) == sizeof(vector_t) && \
+                   offsetof(_name##_vector_t, data) == offsetof(vector_t, data), \
+                   "typed vector layout doesnt match vector_t"); \
+    \
+    static inline _name##_vector_t _name##_vector_from(vector_t vector) { \
+        if(vector.element_size != sizeof(_type)) \
+            PANIC("vector element size [%u] doesnt match " #_type " [%zu]\n", vector.element_size, sizeof(_type)); \
+        return (_name##_vector_t) { .base = vector }; \
+    } \
+    \
+    static inline _name##_vector_t _name##_vector_alloc_new(u32 capacity) { \
+        return (_name##_vector_t) { .base = vector_alloc_new(capacity, sizeof(_type)) }; \
+    } \
+    \
+    static inline _name##_vector_t _name##_vector_alloc_new_expand(u32 capacity, expand_type_t expand_type) { \
+        return (_name##_vector_t) { .base = vector_alloc_new_expand(capacity, sizeof(_type), expand_type) }; \
+    } \
+    \
+    static inline _name##_vector_t arena_##_name##_vector_push(arena_t* arena, u32 num_elements) { \
+        return (_name##_vector_t) { .base = arena_vector_push(arena, num_elements, sizeof(_type)) }; \
+    } \
+    \
+    static inline _type* _name##_vector_get(_name##_vector_t* vector, u32 index) { \
+        if(index >= vector->size) return NULL; \
+        return &vector->data[index]; \
+    } \
+    \
+    /* only goes out of line when the vector has to grow */ \
+    static inline _type* _name##_vector_push(_name##_vector_t* vector, _type value) { \
+        if(vector->size < vector->capacity) { \
+            vector->data[vector->size] = value; \
+            return &vector->data[vector->size ++]; \
+        } \
+        return vector_push_data(&vector->base, &value); \
+    } \
+    \
+    static inline void _name##_vector_remove_swap(_name##_vector_t* vector, u32 index) { \
+        if(index >= vector->size) return; \
+        vector->data[index] = vector->data[-- vector->size]; \
+    } \
+    \
+    static inline void _name##_vector_clear(_name##_vector_t* vector) { \
+        vector->size = 0; \
+    } \
+    \
+    static inline void _name##_vector_destroy(_name##_vector_t* vector) { \
+        vector_destroy(&vector->base); \
+    }
+
+// TYPED POOLS
+#define POOL_DEFINE(_type) POOL_DEFINE_NAMED(_type, _type)
+
+#define POOL_DEFINE_NAMED(_type, _name) \
+    typedef union _name##_pool_t { \
+        pool_t base; \
+        struct { \
+            u32 element_size; \
+            u32 num_in_use; \
+            u32 capacity; \
+            u32 first_free_element; \
+            u32 first_used_element; \
+            u32 last_used_element; \
+            expand_type_t type; \
+            _type* data; \
+            pool_element_t* elements; \
+            u64* occupancy; \
+        }; \
+    } _name##_pool_t; \
+    \
+    _Static_assert(sizeof(_name##_pool_t) == sizeof(pool_t) && \
+                   offsetof(_name##_pool_t, data) == offsetof(pool_t, data) && \
+                   offsetof(_name##_pool_t, occupancy) == offsetof(pool_t, occupancy), \
+                   "typed pool layout doesnt match pool_t"); \
+    \
+    static inline _name##_pool_t _name##_pool_from(pool_t pool) { \
+        if(pool.element_size != sizeof(_type)) \
+            PANIC("pool element size [%u] doesnt match " #_type " [%zu]\n", pool.element_size, sizeof(_type)); \
+        return (_name##_pool_t) { .base = pool }; \
+    } \
+    \
+    static inline _name##_pool_t _name##_pool_alloc_new(u32 capacity) { \
+        return (_name##_pool_t) { .base = pool_alloc_new(capacity, sizeof(_type)) }; \
+    } \
+    \
+    static inline _name##_pool_t _name##_pool_alloc_new_expand(u32 capacity, expand_type_t expand_type) { \
+        return (_name##_pool_t) { .base = pool_alloc_new_expand(capacity, sizeof(_type), expand_type) }; \
+    } \
+    \
+    static inline _name##_pool_t arena_##_name##_pool_push(arena_t* arena, u32 capacity) { \
+        return (_name##_pool_t) { .base = arena_pool_push(arena, capacity, sizeof(_type)) }; \
+    } \
+    \
+    static inline _type* _name##_pool_push(_name##_pool_t* pool, handle_t* out_handle) { \
+        return pool_push(&pool->base, out_handle); \
+    } \
+    \
+    /* same checks as pool_get */ \
+    static inline _type* _name##_pool_get(_name##_pool_t* pool, handle_t handle) { \
+        u32 index = handle & HANDLE_INDEX_MASK; \
+        if(index >= pool->capacity) return NULL; \
+        pool_element_t elem = pool->elements[index]; \
+        if(elem.state == POOL_ELEMENT_FREE || elem.handle != handle) return NULL; \
+        return &pool->data[index]; \
+    } \
+    \
+    static inline _type* _name##_pool_at_index(_name##_pool_t* pool, u32 index) { \
+        if(index > pool->last_used_element || index < pool->first_used_element) return NULL; \
+        return &pool->data[index]; \
+    } \
+    \
+    static inline void _name##_pool_free(_name##_pool_t* pool, handle_t handle) { \
+        pool_free(&pool->base, handle); \
+    } \
+    \
+    static inline void _name##_pool_destroy(_name##_pool_t* pool) { \
+        pool_destroy(&pool->base); \
+    }
+
+#endif
@@ -32,26 +32,24 @@
 physics_ctx_t physics_ctx = {0};
 
 void physics_init() {
-    arena_t physics_rations = arena_new(rations.physics);
-    pool_t obj_pool = arena_pool_push(&physics_rations, PHYS_MAX_OBJS, sizeof(rigidbody_t));
-    arena_t frame_arena = arena_new(arena_range_remaining(&physics_rations));
+    arena_t* physics_rations = &rations.physics;
+    dense_pool_t obj_pool = arena_dense_pool_push(physics_rations, PHYS_MAX_OBJS, sizeof(rigidbody_t));
 
     physics_ctx = (physics_ctx_t) {
         .rations = physics_rations,
         .obj_pool = obj_pool,
-        .frame_arena = frame_arena,
         .substeps = 8,
         .global_gravity = v2f_new(0.0f, -981.0f),
     };
 }
 
 void physics_terminate() {
-    arena_clear(&physics_ctx.rations);
+    arena_clear(physics_ctx.rations);
 }
 
 collider_t collider_new(collider_info_t info) {
     collider_t collider = {0};
-    rigidbody_t* obj = pool_push(&physics_ctx.obj_pool, &collider.id);
+    rigidbody_t* obj = dense_pool_push(&physics_ctx.obj_pool, &collider.id);
 
     obj->tags = info.tags;
     obj->bounds = info.bounds;
@@ -74,11 +72,11 @@ collider_t collider_new(collider_info_t info) {
 }
 
 void collider_destroy(collider_t collider) {
-    pool_free(&physics_ctx.obj_pool, collider.id);
+    dense_pool_free(&physics_ctx.obj_pool, collider.id);
 }
 
 rigidbody_t* collider_get_data(collider_t collider) {
-    return pool_get(&physics_ctx.obj_pool, collider.id);
+    return dense_pool_get(&physics_ctx.obj_pool, collider.id);
 }
 
 void collider_apply_force(collider_t collider, v2f force) {
@@ -88,9 +86,9 @@ void collider_apply_force(collider_t collider, v2f force) {
 }
 
 static void physics_apply_gravity() {
-    pool_iter_t iter = {0};
-    while(pool_iter(&physics_ctx.obj_pool, &iter)) {
-        rigidbody_t* obj = iter.data;
+    rigidbody_t* objs = physics_ctx.obj_pool.data;
+    for(u32 i = 0; i < physics_ctx.obj_pool.count; i ++) {
+        rigidbody_t* obj = &objs[i];
         if(obj->tags & COLLIDER_TAGS_STATIC) continue;
         if(!(obj->tags & COLLIDER_TAGS_NO_GRAV)) obj->force = v2f_add(obj->force, v2f_scale(physics_ctx.global_gravity, obj->mass));
     }
@@ -108,11 +106,10 @@ static void physics_integrate(rigidbody_t* obj, f32 dt) {
 }
 
 static void physics_integrate_objects(f32 dt) {
-    pool_iter_t iter = {0};
-    while(pool_iter(&physics_ctx.obj_pool, &iter)) {
-        rigidbody_t* obj = iter.data;
-        if(obj->tags & COLLIDER_TAGS_STATIC) continue;
-        physics_integrate(obj, dt);
+    rigidbody_t* objs = physics_ctx.obj_pool.data;
+    for(u32 i = 0; i < physics_ctx.obj_pool.count; i ++) {
+        if(objs[i].tags & COLLIDER_TAGS_STATIC) continue;
+        physics_integrate(&objs[i], dt);
     }
 }
 
@@ -122,16 +119,15 @@ static intersection_t physics_collide_objs(rigidbody_t* obj1, rigidbody_t* obj2)
     return aabb_aabb_intersect(b1, b2);
 }
 
-static void physics_collisions_compute_manifolds() {
-    physics_ctx.narrow.pairs = arena_vector_push(&physics_ctx.frame_arena, 128, sizeof(manifold_t));
-    pool_iter_t major_iter = {0};
-    while(pool_iter(&physics_ctx.obj_pool, &major_iter)) {
-        rigidbody_t* obj1 = major_iter.data;
+static void physics_collisions_compute_manifolds(arena_t* frame_arena) {
+    physics_ctx.narrow.pairs = arena_vector_push(frame_arena, 128, sizeof(manifold_t));
+    rigidbody_t* objs = physics_ctx.obj_pool.data;
+    for(u32 i = 0; i < physics_ctx.obj_pool.count; i ++) {
+        rigidbody_t* obj1 = &objs[i];
         if(obj1->tags & COLLIDER_TAGS_STATIC) continue;
-        pool_iter_t minor_iter = {0};
-        while(pool_iter(&physics_ctx.obj_pool, &minor_iter)) {
-            if(major_iter.handle == minor_iter.handle) continue;
-            rigidbody_t* obj2 = minor_iter.data;
+        for(u32 j = 0; j < physics_ctx.obj_pool.count; j ++) {
+            if(i == j) continue;
+            rigidbody_t* obj2 = &objs[j];
             intersection_t inter = physics_collide_objs(obj1, obj2);
             if(inter.inersect) {
                 manifold_t* manifold = vector_push(&physics_ctx.narrow.pairs);
@@ -156,10 +152,14 @@ void physics_update(f32 dt) {
     physics_apply_gravity();
     dt /= physics_ctx.substeps;
 
+    // the narrow phase only needs its memory for the substep
+    // so borrow the frame ring and give it back after each one
+    arena_t* frame_arena = frame_arena_current(&rations.frame);
     for(u32 i = 0; i < physics_ctx.substeps; i ++) {
+        arena_temp_t substep = arena_temp_begin(frame_arena);
         physics_integrate_objects(dt);
-        physics_collisions_compute_manifolds();
+        physics_collisions_compute_manifolds(frame_arena);
         physics_collisions_resolve();
-        arena_clear(&physics_ctx.frame_arena);
+        arena_temp_end(substep);
     }
 }
@@ -92,9 +92,9 @@ typedef struct narrow_phase_t {
 } narrow_phase_t;
 
 typedef struct physics_ctx_t {
-    arena_t rations;
-    pool_t obj_pool;
-    arena_t frame_arena;
+    arena_t* rations;
+    // packed, so pointers to rigidbodies are only good until the next collider_destroy
+    dense_pool_t obj_pool;
 
     u32 substeps;
 
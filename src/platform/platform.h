@@ -21,4 +21,21 @@ f32 platform_get_milli_diff_reset(u64* last_ticks);
 f32 platform_ticks_to_milli(u64 t);
 f32 platform_ticks_to_sec(u64 t);
 
+// virtual memory
+// reserving only takes address space, nothing is backed until it is committed
+// all pointers/sizes should be page aligned (except for reserve, which rounds up)
+usize platform_page_size();
+
+// returns NULL on failure
+void* platform_mem_reserve(usize bytes);
+// makes the pages readable/writable. new pages are always zeroed
+bool platform_mem_commit(void* ptr, usize bytes);
+// gives the physical pages back to the os but keeps the address space reserved
+void platform_mem_decommit(void* ptr, usize bytes);
+void platform_mem_release(void* ptr, usize bytes);
+
+// asks the os to back the range with huge pages where it can
+// only a hint, does nothing if transparent huge pages arent enabled
+void platform_mem_hint_huge_pages(void* ptr, usize bytes);
+
 #endif /* ifndef _PLATFORM_H */
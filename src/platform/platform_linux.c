@@ -4,9 +4,13 @@
 
 // needed to use posix functions (clock_gettime)
 #define _POSIX_C_SOURCE 199309L
+// needed for MAP_ANONYMOUS and the linux specific madvise flags
+#define _DEFAULT_SOURCE
 #include "platform.h"
 #include "util/util.h"
 #include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 // gets the size of the entire file in bytes
 // returns the file cursor to the start
@@ -41,7 +45,8 @@ DEVONLY range_t platform_load_file(arena_t* arena, const char* filename) {
     // but leave a warning
     if(read_length != size) LOG_WARN("read error occured on file [%s]\n", filename);
 
-    output[read_length + 1] = '\0';
+    // the arena memory might not be zeroed (scratch arenas get reused), so terminate it ourselves
+    output[read_length] = '\0';
     fclose(file);
 
     return (range_t) {
@@ -76,4 +81,51 @@ f32 platform_ticks_to_sec(u64 t) {
     return (f32) (t / 1000000000.0f);
 }
 
+usize platform_page_size() {
+    static usize page_size = 0;
+    if(!page_size) page_size = (usize) sysconf(_SC_PAGESIZE);
+    return page_size;
+}
+
+void* platform_mem_reserve(usize bytes) {
+    usize page_size = platform_page_size();
+    bytes = (bytes + page_size - 1) & ~(page_size - 1);
+
+    // NORESERVE so huge reservations dont count against overcommit limits
+    void* ptr = mmap(NULL, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(ptr == MAP_FAILED) {
+        LOG_ERR("couldnt reserve [%zu] bytes of address space\n", bytes);
+        return NULL;
+    }
+
+    return ptr;
+}
+
+bool platform_mem_commit(void* ptr, usize bytes) {
+    if(mprotect(ptr, bytes, PROT_READ | PROT_WRITE) != 0) {
+        LOG_ERR("couldnt commit [%zu] bytes\n", bytes);
+        return false;
+    }
+
+    return true;
+}
+
+void platform_mem_decommit(void* ptr, usize bytes) {
+    madvise(ptr, bytes, MADV_DONTNEED);
+    mprotect(ptr, bytes, PROT_NONE);
+}
+
+void platform_mem_release(void* ptr, usize bytes) {
+    munmap(ptr, bytes);
+}
+
+void platform_mem_hint_huge_pages(void* ptr, usize bytes) {
+#if defined(MADV_HUGEPAGE)
+    madvise(ptr, bytes, MADV_HUGEPAGE);
+#else
+    UNUSED(ptr);
+    UNUSED(bytes);
+#endif
+}
+
 #endif
@@ -1,30 +1,189 @@
 #include "rations.h"
+#include "platform/platform.h"
+#include "util/util.h"
 
 rations_t rations = {0};
 
+typedef struct ration_info_t {
+    const char* name;
+    arena_t* arena;
+    usize default_budget;
+
+    // what actually got committed this run
+    usize budget;
+    // peak from the loaded profile, 0 if there wasnt one
+    usize profiled_peak;
+} ration_info_t;
+
+static ration_info_t ration_infos[] = {
+    { .name = "entity",  .arena = &rations.entity,  .default_budget = RATIONS_ENTITY  },
+    { .name = "io",      .arena = &rations.io,      .default_budget = RATIONS_IO      },
+    { .name = "gfx",     .arena = &rations.gfx,     .default_budget = RATIONS_GFX     },
+    { .name = "render",  .arena = &rations.render,  .default_budget = RATIONS_RENDER  },
+    { .name = "physics", .arena = &rations.physics, .default_budget = RATIONS_PHYSICS },
+    { .name = "events",  .arena = &rations.events,  .default_budget = RATIONS_EVENTS  },
+    { .name = "game",    .arena = &rations.game,    .default_budget = RATIONS_GAME    },
+};
+
+#define NUM_RATIONS (sizeof(ration_infos) / sizeof(ration_infos[0]))
+
+// the frame ring isnt a normal ration, but its peak gets profiled the same way
+#define FRAME_RATION_NAME "frame"
+static usize frame_profiled_peak = 0;
+
+static ration_info_t* rations_find(const char* name) {
+    for(u32 i = 0; i < NUM_RATIONS; i ++) {
+        if(strcmp(ration_infos[i].name, name) == 0) return &ration_infos[i];
+    }
+
+    return NULL;
+}
+
+// a missing profile is fine, just means we use the defaults
+static bool rations_load_profile() {
+    FILE* file = fopen(RATIONS_PROFILE_PATH, "r");
+    if(!file) return false;
+
+    char line[128];
+    while(fgets(line, sizeof(line), file)) {
+        if(line[0] == '#' || line[0] == '\n') continue;
+
+        char name[32];
+        usize peak;
+        u32 overflows;
+        if(sscanf(line, "%31s %zu %u", name, &peak, &overflows) != 3) {
+            LOG_WARN("bad line in rations profile [%s]\n", line);
+            continue;
+        }
+
+        if(strcmp(name, FRAME_RATION_NAME) == 0) {
+            frame_profiled_peak = peak;
+            continue;
+        }
+
+        ration_info_t* info = rations_find(name);
+        if(!info) {
+            LOG_WARN("unknown ration [%s] in profile\n", name);
+            continue;
+        }
+
+        info->profiled_peak = peak;
+    }
+
+    fclose(file);
+    return true;
+}
+
+// give profiled rations a quarter on top of their peak for headroom
+// commit whole pages, so small budgets still get a full page
+static usize rations_budget(bool profiled, usize profiled_peak, usize default_budget) {
+    usize page_size = platform_page_size();
+    usize budget = profiled ? profiled_peak + profiled_peak / 4 : default_budget;
+    return ALIGN_UP(MAX(budget, page_size), page_size);
+}
+
+static arena_t rations_take(range_t* bank_remaining, usize budget) {
+    range_t block = range_new(bank_remaining->ptr, RATIONS_RESERVE);
+    bank_remaining->ptr += RATIONS_RESERVE;
+    bank_remaining->size -= RATIONS_RESERVE;
+
+    if(!platform_mem_commit(block.ptr, budget)) PANIC("couldnt commit rations\n");
+
+    return arena_virtual_new_in(block, budget);
+}
+
 void rations_divide() {
-    const u32 total =
-        RATIONS_EVENTS  +
-        RATIONS_IO      +
-        RATIONS_GFX     +
-        RATIONS_RENDER  + 
-        RATIONS_PHYSICS +
-        RATIONS_ENTITY  +
-        RATIONS_GAME;
-
-    rations.bank = range_alloc_new(total);
-    mem_clear(rations.bank.ptr, total);
-    arena_t bank = arena_new(rations.bank);
-
-    rations.entity  = arena_range_push(&bank, RATIONS_ENTITY);
-    rations.io      = arena_range_push(&bank, RATIONS_IO);
-    rations.gfx     = arena_range_push(&bank, RATIONS_GFX);
-    rations.render  = arena_range_push(&bank, RATIONS_RENDER);
-    rations.physics = arena_range_push(&bank, RATIONS_PHYSICS);
-    rations.events  = arena_range_push(&bank, RATIONS_EVENTS);
-    rations.game    = arena_range_push(&bank, RATIONS_GAME);
+    bool profiled = rations_load_profile();
+
+    const usize total = NUM_RATIONS * RATIONS_RESERVE;
+
+    // the bank is reserved but only the budgets get committed
+    // so reserving a lot of address space here doesnt cost anything
+    void* bank = platform_mem_reserve(total);
+    if(!bank) PANIC("couldnt reserve rations bank\n");
+    platform_mem_hint_huge_pages(bank, total);
+
+    rations.bank = range_new(bank, total);
+    range_t remaining = rations.bank;
+
+    for(u32 i = 0; i < NUM_RATIONS; i ++) {
+        ration_info_t* info = &ration_infos[i];
+
+        usize budget = rations_budget(profiled, info->profiled_peak, info->default_budget);
+        budget = MIN(budget, (usize) RATIONS_RESERVE);
+
+        info->budget = budget;
+        *info->arena = rations_take(&remaining, budget);
+    }
+
+    usize frame_budget = rations_budget(profiled && frame_profiled_peak, frame_profiled_peak, RATIONS_FRAME);
+    frame_budget = MIN(frame_budget, (usize) FRAME_ARENA_RESERVE);
+    rations.frame = frame_arena_new(RATIONS_FRAME_LATENCY, frame_budget);
+}
+
+void rations_end_frame() {
+    frame_arena_advance(&rations.frame);
+
+#if defined(MEMORY_TRACK_ALLOCS)
+    memtrack_end_frame();
+#endif
+}
+
+void rations_report() {
+    for(u32 i = 0; i < NUM_RATIONS; i ++) {
+        ration_info_t* info = &ration_infos[i];
+        arena_t* arena = info->arena;
+
+        f32 percent = arena->size ? 100.0f * arena->padding / arena->size : 0.0f;
+        LOG("[%s] used [%zu] bytes, [%zu] of them padding (%.1f%%), peak [%zu] of [%zu] budget\n",
+            info->name, arena->size, arena->padding, percent, arena->high_water, info->budget);
+
+        if(arena->overflows > 0) {
+            LOG_WARN("ration [%s] went over its budget [%u] times, peaked at [%zu] bytes\n",
+                     info->name, arena->overflows, arena->high_water);
+        }
+    }
+
+    frame_arena_t* frame = &rations.frame;
+    LOG("[%s] peak [%zu] of [%zu] budget per frame, [%u] frames of latency\n",
+        FRAME_RATION_NAME, frame->high_water, frame->budget, frame->latency);
+
+    if(frame->overflows > 0) {
+        LOG_WARN("[%u] of [%zu] frames went over the frame budget, peaked at [%zu] bytes\n",
+                 frame->overflows, (usize) frame->frame, frame->high_water);
+    }
+}
+
+void rations_save_profile() {
+    FILE* file = fopen(RATIONS_PROFILE_PATH, "w");
+    if(!file) {
+        LOG_ERR("couldnt open [%s] to save rations profile\n", RATIONS_PROFILE_PATH);
+        return;
+    }
+
+    fprintf(file, "# rations profile, written at shutdown\n");
+    fprintf(file, "# name peak_bytes overflows\n");
+
+    for(u32 i = 0; i < NUM_RATIONS; i ++) {
+        ration_info_t* info = &ration_infos[i];
+        usize peak = MAX(info->arena->high_water, info->profiled_peak);
+        fprintf(file, "%s %zu %u\n", info->name, peak, info->arena->overflows);
+    }
+
+    usize frame_peak = MAX(rations.frame.high_water, frame_profiled_peak);
+    fprintf(file, "%s %zu %u\n", FRAME_RATION_NAME, frame_peak, rations.frame.overflows);
+
+    fclose(file);
 }
 
 void rations_destroy() {
-    range_destroy(&rations.bank);
+    frame_arena_destroy(&rations.frame);
+
+    // anything still on the heap by now is a leak
+#if defined(MEMORY_TRACK_ALLOCS)
+    memtrack_report_sites();
+    memtrack_report_live();
+#endif
+    platform_mem_release(rations.bank.ptr, rations.bank.size);
+    rations.bank = RANGE_EMPTY;
 }
@@ -4,7 +4,13 @@
 #include "base.h"
 #include "memory/memory.h"
 
+// each system gets RATIONS_RESERVE of address space in the bank
+// the budgets below are what each one is expected to use, and get committed up front
+// going over a budget just commits more pages, the data never moves
+// NOTE(nix3l): if a profile from an earlier run exists, the budgets come from that instead
 enum {
+    RATIONS_RESERVE = MEGABYTES(64),
+
     RATIONS_EVENTS  = KILOBYTES(4),
     RATIONS_IO      = KILOBYTES(4),
     RATIONS_GFX     = MEGABYTES(1),
@@ -12,23 +18,45 @@ enum {
     RATIONS_PHYSICS = MEGABYTES(1),
     RATIONS_ENTITY  = MEGABYTES(1),
     RATIONS_GAME    = KILOBYTES(1),
+
+    // per frame budget of the frame ring, and how many frames its memory lives for
+    RATIONS_FRAME = MEGABYTES(1),
+    RATIONS_FRAME_LATENCY = 3,
 };
 
+// written at shutdown, read by the next rations_divide
+// holds the peak usage of each ration, budgets get that plus some headroom
+#define RATIONS_PROFILE_PATH "rations.profile"
+
+// systems keep a pointer to their arena in here
 typedef struct rations_t {
     range_t bank;
 
-    range_t io;
-    range_t gfx;
-    range_t render;
-    range_t physics;
-    range_t entity;
-    range_t events;
-    range_t game;
+    arena_t io;
+    arena_t gfx;
+    arena_t render;
+    arena_t physics;
+    arena_t entity;
+    arena_t events;
+    arena_t game;
+
+    // memory that only has to live for a few frames (draw batches, per frame scratch)
+    frame_arena_t frame;
 } rations_t;
 
 extern rations_t rations;
 
 void rations_divide();
+// moves the frame ring on (and ends the frame for the allocation tracker if its on)
+// call once at the very end of every frame
+void rations_end_frame();
+// logs how much of each ration is used, its peak and how much of that is alignment padding
+// warns about any ration that went over its budget
+void rations_report();
+// writes the peak usage of every ration to RATIONS_PROFILE_PATH
+// peaks from the loaded profile are kept if they are higher, so a short run doesnt shrink the budgets
+void rations_save_profile();
+// with MEMORY_TRACK_ALLOCS this also lists every heap allocation that is still live
 void rations_destroy();
 
 #endif
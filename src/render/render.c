@@ -41,14 +41,14 @@ void render_init() {
     });
 
     render_ctx = (render_ctx_t) {
-        .rations = arena_new(rations.render),
+        .rations = &rations.render,
         .unit_square = mesh,
         .active_group = {0},
     };
 }
 
 void render_terminate() {
-    arena_clear(&render_ctx.rations);
+    arena_clear(render_ctx.rations);
 }
 
 void render_activate_group(draw_group_t group) {
@@ -82,9 +82,24 @@ draw_pass_cache_t* render_get_active_cache() {
 }
 
 void render_push_draw_call(draw_group_t* group, draw_call_t call) {
-    draw_call_t* data = arena_push(&render_ctx.rations, sizeof(draw_call_t));
-    memcpy(data, &call, sizeof(draw_call_t));
-    llist_push(&group->batch, &render_ctx.rations, data);
+    // the batch only lives for the frame, so it goes in the frame ring
+    clist_push_data(&group->batch, frame_arena_current(&rations.frame), &call);
+}
+
+void render_construct_instance(void* out, draw_call_t* call) {
+    draw_instance_t* instance = out;
+
+    memcpy(instance->position, call->position.raw, sizeof(vec3));
+    instance->rotation = call->rotation.z;
+    instance->scale[0] = call->scale.x;
+    instance->scale[1] = call->scale.y;
+    instance->layer = call->layer;
+    instance->_pad = 0.0f;
+    memcpy(instance->colour, call->colour.raw, sizeof(vec4));
+
+    bool whole = call->min.x == call->max.x && call->min.y == call->max.y;
+    v4f rect = whole ? v4f_new(0.0f, 0.0f, 1.0f, 1.0f) : v4f_new(call->min.x, call->min.y, call->max.x, call->max.y);
+    memcpy(instance->rect, rect.raw, sizeof(vec4));
 }
 
 static mat4s pass_get_proj_view(draw_pass_t pass) {
@@ -115,6 +130,98 @@ static void render_group_update_cache() {
     };
 }
 
+static void render_upload_pass_uniforms(draw_pass_t pass) {
+    uniform_buffer_t* buffer = shader_get_uniform_buffer(pass.pipeline.shader, UNIFORM_BLOCK_RATE_PASS);
+    if(!buffer) return;
+
+    if(buffer->bytes != sizeof(draw_pass_uniforms_t)) {
+        LOG_ERR("pass uniform buffer [%s] doesnt match draw_pass_uniforms_t\n", buffer->name);
+        return;
+    }
+
+    draw_pass_uniforms_t* out = shader_map_uniform_buffer(pass.pipeline.shader, buffer->index, 1);
+    if(!out) return;
+    memcpy(out->proj_view, pass.cache.proj_view.raw, sizeof(mat4));
+    shader_unmap_uniform_buffer(pass.pipeline.shader, buffer->index);
+
+    shader_bind_uniform_buffer(pass.pipeline.shader, buffer->index, 0);
+}
+
+static void render_bind_call(draw_call_t* call) {
+    gfx_supply_bindings((render_bindings_t) {
+        .mesh = render_ctx.unit_square,
+        .texture_samplers = {
+            [0] = call->sampler,
+        },
+    });
+}
+
+// the whole batch gets written into the draw buffer in one go, then each draw just picks its copy
+static void render_dispatch_buffered(draw_group_t group, uniform_buffer_t* buffer) {
+    shader_t shader = group.pass.pipeline.shader;
+    if(group.batch.size == 0) return;
+
+    void* out = shader_map_uniform_buffer(shader, buffer->index, group.batch.size);
+    if(!out) return;
+
+    clist_iter_t iter = {0};
+    u32 written = 0;
+    while(clist_iter(&group.batch, &iter)) {
+        group.construct_uniforms(out + written * buffer->stride, iter.data);
+        written ++;
+    }
+
+    shader_unmap_uniform_buffer(shader, buffer->index);
+
+    iter = (clist_iter_t) {0};
+    u32 drawn = 0;
+    while(clist_iter(&group.batch, &iter)) {
+        render_bind_call(iter.data);
+        shader_bind_uniform_buffer(shader, buffer->index, drawn);
+        gfx_draw();
+        drawn ++;
+    }
+}
+
+// every call in an instanced batch shares the first call's texture, anything that
+// needs a different one should pick its part of an atlas through draw_instance_t.rect
+static void render_dispatch_instanced(draw_group_t group) {
+    shader_t shader = group.pass.pipeline.shader;
+    uniform_buffer_t* buffer = shader_get_uniform_buffer(shader, UNIFORM_BLOCK_RATE_INSTANCE);
+    if(!buffer) {
+        LOG_ERR("instanced pass [%s] has a shader with no instance buffer\n", group.pass.label);
+        return;
+    }
+
+    if(group.batch.size == 0) return;
+
+    void* out = shader_map_uniform_buffer(shader, buffer->index, group.batch.size);
+    if(!out) return;
+
+    draw_call_t* first = NULL;
+    bool mixed_samplers = false;
+
+    clist_iter_t iter = {0};
+    u32 written = 0;
+    while(clist_iter(&group.batch, &iter)) {
+        draw_call_t* call = iter.data;
+        if(!first) first = call;
+        else if(call->sampler.texture.id != first->sampler.texture.id || call->sampler.sampler.id != first->sampler.sampler.id)
+            mixed_samplers = true;
+
+        group.construct_uniforms(out + written * buffer->stride, call);
+        written ++;
+    }
+
+    shader_unmap_uniform_buffer(shader, buffer->index);
+
+    if(mixed_samplers) LOG_WARN("instanced pass [%s] has calls with different samplers, using the first\n", group.pass.label);
+
+    render_bind_call(first);
+    shader_bind_uniform_buffer(shader, buffer->index, 0);
+    gfx_draw_instanced(written);
+}
+
 static void render_dispatch_active_group() {
     draw_group_t group = render_ctx.active_group;
     draw_pass_t pass = group.pass;
@@ -123,23 +230,32 @@ static void render_dispatch_active_group() {
         return;
     }
 
-    // TODO(nix3l): maybe move this to the rations? maybe dont? i dont think it would really impact performace. like at all.
-    range_t uniforms = range_alloc_new(shader_get_uniforms_size(pass.pipeline.shader));
+    render_upload_pass_uniforms(pass);
+
+    if(pass.type == DRAW_PASS_RENDER_INSTANCED) {
+        render_dispatch_instanced(group);
+        return;
+    }
 
-    llist_iter_t iter = {0};
-    while(llist_iter(&group.batch, &iter)) {
+    uniform_buffer_t* draw_buffer = shader_get_uniform_buffer(pass.pipeline.shader, UNIFORM_BLOCK_RATE_DRAW);
+    if(draw_buffer) {
+        render_dispatch_buffered(group, draw_buffer);
+        return;
+    }
+
+    arena_temp_t scratch = scratch_begin(NULL, 0);
+    range_t uniforms = arena_range_push(scratch.arena, shader_get_uniforms_size(pass.pipeline.shader));
+    mem_clear(uniforms.ptr, uniforms.size);
+
+    clist_iter_t iter = {0};
+    while(clist_iter(&group.batch, &iter)) {
         draw_call_t* call = iter.data;
         if(!call) {
             LOG_ERR_CODE(ERR_RENDER_BAD_CALL);
             UNREACHABLE; // bit harsh but just to make sure in dev
         }
 
-        gfx_supply_bindings((render_bindings_t) {
-            .mesh = render_ctx.unit_square,
-            .texture_samplers = {
-                [0] = call->sampler,
-            },
-        });
+        render_bind_call(call);
 
         group.construct_uniforms(uniforms.ptr, call);
 
@@ -149,7 +265,7 @@ static void render_dispatch_active_group() {
         mem_clear(uniforms.ptr, uniforms.size);
     }
 
-    range_destroy(&uniforms);
+    scratch_end(scratch);
 }
 
 void render_dispatch(renderer_t* renderer) {
@@ -157,12 +273,9 @@ void render_dispatch(renderer_t* renderer) {
         render_activate_group(renderer->groups[i]);
         render_group_update_cache();
         render_dispatch_active_group();
-        llist_clear(&renderer->groups[i].batch);
+        clist_clear(&renderer->groups[i].batch);
         render_clear_active_group();
         gfx_clear_active_pipeline();
     }
 }
 
-void render_end_frame() {
-    arena_clear(&render_ctx.rations);
-}
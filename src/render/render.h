@@ -4,6 +4,8 @@
 #include "base.h"
 #include "gfx/gfx.h"
 
+#include <stddef.h>
+
 // TODO(nix3l): move viewport to pipeline?
 
 enum {
@@ -41,7 +43,8 @@ typedef struct draw_viewport_t {
 typedef enum draw_pass_type_t {
     DRAW_PASS_INVALID = 0,
     DRAW_PASS_RENDER,
-    // DRAW_PASS_RENDER_INSTANCED,
+    // the whole batch goes out as one instanced draw, see draw_instance_t
+    DRAW_PASS_RENDER_INSTANCED,
     // DRAW_PASS_POSTPROCESS,
     // DRAW_PASS_COMPUTE,
 } draw_pass_type_t;
@@ -56,6 +59,12 @@ typedef struct draw_pass_cache_t {
     mat4s proj_view;
 } draw_pass_cache_t;
 
+// what the renderer writes into a shader's UNIFORM_BLOCK_RATE_PASS buffer, in std140:
+//  layout(std140) uniform pass_block { mat4 proj_view; };
+typedef struct draw_pass_uniforms_t {
+    mat4 proj_view;
+} draw_pass_uniforms_t;
+
 typedef struct draw_pass_t {
     const char* label;
     draw_pass_type_t type;
@@ -78,13 +87,36 @@ typedef struct draw_call_t {
     v4f colour;
     v4f bg;
     f32 stroke;
-    // i32 layer;
+    u32 layer; // for array textures in sampler
     sampler_slot_t sampler;
 } draw_call_t;
 
+// what render_construct_instance writes for each call into a shader's UNIFORM_BLOCK_RATE_INSTANCE buffer, in std430:
+//  struct instance_t { vec3 position; float rotation; vec2 scale; uint layer; vec4 colour; vec4 rect; };
+//  layout(std430) readonly buffer instance_block { instance_t instances[]; };
+typedef struct draw_instance_t {
+    vec3 position;
+    f32 rotation; // around z, in degrees
+    vec2 scale;
+    u32 layer; // array layer to sample, see sampler_slot_t
+    f32 _pad;
+    vec4 colour;
+    vec4 rect; // uv rect inside an atlas, min in xy and max in zw
+} draw_instance_t;
+
+_Static_assert(offsetof(draw_instance_t, colour) == 32, "draw_instance_t doesnt match std430");
+_Static_assert(sizeof(draw_instance_t) == 64, "draw_instance_t doesnt match std430");
+
+// number of draw calls stored per chunk in a group's batch
+enum { DRAW_BATCH_CHUNK_SIZE = 256 };
+
 typedef struct draw_group_t {
-    llist_t batch;
+    clist_t batch; // of draw_call_t
     draw_pass_t pass;
+    // if the shader has a UNIFORM_BLOCK_RATE_DRAW buffer, *out points straight into it and has to be
+    // written in std140. instanced passes write one instance into the instance buffer the same way,
+    // render_construct_instance does that for draw_instance_t.
+    // otherwise its a packed struct matching the shader's loose uniforms
     // TODO(nix3l): change *out to an arena and add helper functions for each uniform type
     void (*construct_uniforms) (void* out, draw_call_t* call);
 } draw_group_t;
@@ -98,6 +130,10 @@ draw_pass_cache_t* render_get_active_cache();
 
 void render_push_draw_call(draw_group_t* group, draw_call_t call);
 
+// construct_uniforms for instanced passes using draw_instance_t
+// a call with no min/max gets the whole texture
+void render_construct_instance(void* out, draw_call_t* call);
+
 // RENDERER
 typedef struct renderer_t {
     const char* label;
@@ -109,7 +145,7 @@ void render_dispatch(renderer_t* renderer);
 
 // CONTEXT
 typedef struct render_ctx_t {
-    arena_t rations;
+    arena_t* rations;
     mesh_t unit_square;
     draw_group_t active_group;
 } render_ctx_t;
@@ -119,6 +155,4 @@ extern render_ctx_t render_ctx;
 void render_init();
 void render_terminate();
 
-void render_end_frame();
-
 #endif
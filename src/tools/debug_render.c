@@ -48,11 +48,10 @@ static void circle_construct_uniforms(void* out, draw_call_t* call) {
 }
 
 void debug_render_init() {
-    // yeah im leaking memory sue me
-    arena_t arena = arena_alloc_new(4096);
+    arena_temp_t scratch = scratch_begin(NULL, 0);
 
-    range_t rect_vs = platform_load_file(&arena, "shader/debug/rect.vs");
-    range_t rect_fs = platform_load_file(&arena, "shader/debug/rect.fs");
+    range_t rect_vs = platform_load_file(scratch.arena, "shader/debug/rect.vs");
+    range_t rect_fs = platform_load_file(scratch.arena, "shader/debug/rect.fs");
     shader_t rect_shader = shader_new((shader_info_t) {
         .name = "rect-shader",
         .attribs = {
@@ -67,8 +66,8 @@ void debug_render_init() {
         .fragment_src = rect_fs,
     });
 
-    range_t circle_vs = platform_load_file(&arena, "shader/debug/circle.vs");
-    range_t circle_fs = platform_load_file(&arena, "shader/debug/circle.fs");
+    range_t circle_vs = platform_load_file(scratch.arena, "shader/debug/circle.vs");
+    range_t circle_fs = platform_load_file(scratch.arena, "shader/debug/circle.fs");
     shader_t circle_shader = shader_new((shader_info_t) {
         .name = "circle-shader",
         .attribs = {
@@ -84,6 +83,8 @@ void debug_render_init() {
         .fragment_src = circle_fs,
     });
 
+    scratch_end(scratch);
+
     renderer_t renderer = (renderer_t) {
         .label = "debug-renderer",
         .num_groups = 2,
@@ -101,7 +102,7 @@ void debug_render_init() {
                         .projection.type = PROJECTION_ORTHO,
                     },
                 },
-                .batch = llist_new(),
+                .batch = clist_new(sizeof(draw_call_t), DRAW_BATCH_CHUNK_SIZE),
                 .construct_uniforms = rect_construct_uniforms,
             },
             [1] = {
@@ -117,7 +118,7 @@ void debug_render_init() {
                         .projection.type = PROJECTION_ORTHO,
                     },
                 },
-                .batch = llist_new(),
+                .batch = clist_new(sizeof(draw_call_t), DRAW_BATCH_CHUNK_SIZE),
                 .construct_uniforms = circle_construct_uniforms,
             },
         },
@@ -218,22 +218,6 @@ static void grid_construct_uniforms(void* out, draw_call_t* call) {
     UNUSED(call);
 }
 
-static void room_construct_uniforms(void* out, draw_call_t* call) {
-    draw_pass_cache_t* cache = render_get_active_cache();
-
-    struct  __attribute__((packed)){
-        mat4 model_mat;
-        vec4 col;
-    } uniforms;
-
-    mat4s model_mat = glms_mat4_mul(cache->proj_view, model_matrix_new(call->position, call->rotation, call->scale));
-    glm_mat4_copy(model_mat.raw, uniforms.model_mat);
-
-    memcpy(uniforms.col, call->colour.raw, sizeof(vec4));
-
-    memcpy(out, &uniforms, sizeof(uniforms));
-}
-
 static void selection_construct_uniforms(void* out, draw_call_t* call) {
     struct __attribute__((packed)) {
         vec2 start;
@@ -256,10 +240,9 @@ static void selection_construct_uniforms(void* out, draw_call_t* call) {
 
 // STATE
 void editor_init() {
-    // leak ALL the memory
-    arena_t code_arena = arena_alloc_new(4096);
-    range_t grid_vs = platform_load_file(&code_arena, "shader/editor/grid.vs");
-    range_t grid_fs = platform_load_file(&code_arena, "shader/editor/grid.fs");
+    arena_temp_t scratch = scratch_begin(NULL, 0);
+    range_t grid_vs = platform_load_file(scratch.arena, "shader/editor/grid.vs");
+    range_t grid_fs = platform_load_file(scratch.arena, "shader/editor/grid.fs");
     shader_t grid_shader = shader_new((shader_info_t) {
         .name = "grid shader",
         .attribs = {
@@ -280,24 +263,43 @@ void editor_init() {
         .fragment_src = grid_fs,
     });
 
-    range_t tile_vs = platform_load_file(&code_arena, "shader/editor/tile.vs");
-    range_t tile_fs = platform_load_file(&code_arena, "shader/editor/tile.fs");
+    range_t tile_vs = platform_load_file(scratch.arena, "shader/editor/tile.vs");
+    range_t tile_fs = platform_load_file(scratch.arena, "shader/editor/tile.fs");
     shader_t tile_shader = shader_new((shader_info_t) {
         .name = "room shader",
         .attribs = {
             { .name = "vs_position" },
             { .name = "vs_uvs" },
         },
-        .uniforms = {
-            { .name = "model_mat", .type = UNIFORM_TYPE_mat4, },
-            { .name = "col", .type = UNIFORM_TYPE_v4f, },
+        .buffers = {
+            {
+                .name = "pass_block",
+                .rate = UNIFORM_BLOCK_RATE_PASS,
+                .bytes = sizeof(draw_pass_uniforms_t),
+                .uniforms = {
+                    { .name = "proj_view", .type = UNIFORM_TYPE_mat4, },
+                },
+            },
+            {
+                .name = "instance_block",
+                .rate = UNIFORM_BLOCK_RATE_INSTANCE,
+                .bytes = sizeof(draw_instance_t),
+                .uniforms = {
+                    { .name = "position", .type = UNIFORM_TYPE_v3f, },
+                    { .name = "rotation", .type = UNIFORM_TYPE_f32, },
+                    { .name = "scale", .type = UNIFORM_TYPE_v2f, },
+                    { .name = "layer", .type = UNIFORM_TYPE_u32, },
+                    { .name = "colour", .type = UNIFORM_TYPE_v4f, },
+                    { .name = "rect", .type = UNIFORM_TYPE_v4f, },
+                },
+            },
         },
         .vertex_src = tile_vs,
         .fragment_src = tile_fs,
     });
 
-    range_t outline_vs = platform_load_file(&code_arena, "shader/editor/outline.vs");
-    range_t outline_fs = platform_load_file(&code_arena, "shader/editor/outline.fs");
+    range_t outline_vs = platform_load_file(scratch.arena, "shader/editor/outline.vs");
+    range_t outline_fs = platform_load_file(scratch.arena, "shader/editor/outline.fs");
     shader_t outline_shader = shader_new((shader_info_t) {
         .name = "selection shader",
         .attribs = {
@@ -315,6 +317,8 @@ void editor_init() {
         .fragment_src = outline_fs,
     });
 
+    scratch_end(scratch);
+
     texture_t col_target = texture_new((texture_info_t) {
         .type = TEXTURE_TYPE_2D,
         .format = TEXTURE_FORMAT_RGBA32F,
@@ -357,13 +361,13 @@ void editor_init() {
                         .shader = grid_shader,
                     },
                 },
-                .batch = llist_new(),
+                .batch = clist_new(sizeof(draw_call_t), DRAW_BATCH_CHUNK_SIZE),
                 .construct_uniforms = grid_construct_uniforms,
             },
             [1] = {
                 .pass = {
                     .label = "tile pass",
-                    .type = DRAW_PASS_RENDER,
+                    .type = DRAW_PASS_RENDER_INSTANCED,
                     .pipeline = {
                         .clear = { .depth = true, },
                         .cull.enable = true,
@@ -384,8 +388,8 @@ void editor_init() {
                         .projection = { .type = PROJECTION_ORTHO, },
                     },
                 },
-                .batch = llist_new(),
-                .construct_uniforms = room_construct_uniforms,
+                .batch = clist_new(sizeof(draw_call_t), DRAW_BATCH_CHUNK_SIZE),
+                .construct_uniforms = render_construct_instance,
             },
             [2] = {
                 .pass = {
@@ -405,7 +409,7 @@ void editor_init() {
                         .shader = outline_shader,
                     },
                 },
-                .batch = llist_new(),
+                .batch = clist_new(sizeof(draw_call_t), DRAW_BATCH_CHUNK_SIZE),
                 .construct_uniforms = selection_construct_uniforms,
             },
         }
@@ -442,11 +446,16 @@ void editor_init() {
         },
 
         .room = room,
+
+        .selection = {
+            // big enough to hold every tile in the room, so selecting never has to allocate
+            .tiles = v2i_vector_alloc_new(ROOM_WIDTH * ROOM_HEIGHT),
+        },
     };
 }
 
 void editor_terminate() {
-    // do stuff
+    v2i_vector_destroy(&editor_ctx.selection.tiles);
 }
 
 void editor_set_open(bool open) {
@@ -633,11 +642,9 @@ static bool editor_tile_selected(v2i pos) {
     if(pos.x < editor_ctx.selection.min.x || pos.x > editor_ctx.selection.max.x) return false;
     if(pos.y < editor_ctx.selection.min.y || pos.y > editor_ctx.selection.max.y) return false;
 
-    vector_t* tiles = &editor_ctx.selection.tiles;
+    v2i_vector_t* tiles = &editor_ctx.selection.tiles;
     for(u32 i = 0; i < tiles->size; i ++) {
-        v2i* tile = vector_get(tiles, i);
-        if(!tile) continue;
-        if(tile->x == pos.x && tile->y == pos.y) return true;
+        if(tiles->data[i].x == pos.x && tiles->data[i].y == pos.y) return true;
     }
 
     return false;
@@ -724,17 +731,15 @@ static void editor_selection_clear() {
     editor_ctx.selection.selected = false;
     editor_ctx.selection.min = v2i_new(-1, -1);
     editor_ctx.selection.max = v2i_new(-1, -1);
-    vector_destroy(&editor_ctx.selection.tiles);
+    v2i_vector_clear(&editor_ctx.selection.tiles);
 }
 
 static void editor_selection_delete() {
     if(!editor_ctx.selection.selected) return;
 
-    vector_t* tiles = &editor_ctx.selection.tiles;
+    v2i_vector_t* tiles = &editor_ctx.selection.tiles;
     for(u32 i = 0; i < tiles->size; i ++) {
-        v2i* tile = vector_get(tiles, i);
-        if(!tile) continue;
-        editor_tile_delete(*tile);
+        editor_tile_delete(tiles->data[i]);
     }
 
     editor_selection_clear();
@@ -751,18 +756,6 @@ static void editor_select_range(v2i min, v2i max) {
 
     editor_selection_clear();
 
-    u32 num_tiles = 0;
-    for(i32 y = min.y; y <= max.y; y ++) {
-        for(i32 x = min.x; x <= max.x; x ++) {
-            tile_t tile = room_get_tile(&editor_ctx.room, x, y);
-            if(tile.tags != TILE_TAGS_NONE) num_tiles ++;
-        }
-    }
-
-    if(num_tiles == 0) return;
-
-    editor_ctx.selection.tiles = vector_alloc_new(num_tiles, sizeof(v2i));
-
     v2i range_min = max;
     v2i range_max = min;
 
@@ -770,7 +763,7 @@ static void editor_select_range(v2i min, v2i max) {
         for(i32 x = min.x; x <= max.x; x ++) {
             tile_t tile = room_get_tile(&editor_ctx.room, x, y);
             if(tile.tags != TILE_TAGS_NONE) {
-                vector_push_data(&editor_ctx.selection.tiles, &v2i_new(x, y));
+                v2i_vector_push(&editor_ctx.selection.tiles, v2i_new(x, y));
                 range_min.x = MIN(range_min.x, x);
                 range_min.y = MIN(range_min.y, y);
                 range_max.x = MAX(range_max.x, x);
@@ -779,6 +772,8 @@ static void editor_select_range(v2i min, v2i max) {
         }
     }
 
+    if(editor_ctx.selection.tiles.size == 0) return;
+
     editor_ctx.selection.selected = true;
     editor_ctx.selection.min = range_min;
     editor_ctx.selection.max = range_max;
@@ -797,10 +792,9 @@ static void editor_selection_update() {
     if(!editor_ctx.selection.selected) return;
 
     bool edge_tile_removed = false;
-    vector_t* tiles = &editor_ctx.selection.tiles;
+    v2i_vector_t* tiles = &editor_ctx.selection.tiles;
     for(i32 i = tiles->size - 1; i >= 0; i --) {
-        v2i* pos = vector_get(tiles, i);
-        if(!pos) continue;
+        v2i* pos = &tiles->data[i];
 
         tile_t tile = room_get_tile(&editor_ctx.room, pos->x, pos->y);
         if(tile.tags == TILE_TAGS_NONE) {
@@ -809,7 +803,8 @@ static void editor_selection_update() {
             if(pos->y == editor_ctx.selection.min.y) edge_tile_removed = true;
             if(pos->y == editor_ctx.selection.max.y) edge_tile_removed = true;
 
-            vector_remove(tiles, i);
+            // going backwards, so whatever gets swapped in was already checked
+            v2i_vector_remove_swap(tiles, i);
         }
     }
 
@@ -817,8 +812,7 @@ static void editor_selection_update() {
         v2i range_min = editor_ctx.selection.max;
         v2i range_max = editor_ctx.selection.min;
         for(u32 i = 0; i < tiles->size; i ++) {
-            v2i* pos = vector_get(tiles, i);
-            if(!pos) continue;
+            v2i* pos = &tiles->data[i];
             range_min.x = MIN(range_min.x, pos->x);
             range_min.y = MIN(range_min.y, pos->y);
             range_max.x = MAX(range_max.x, pos->x);
@@ -851,7 +845,7 @@ static void editor_selection_show_info() {
         igText("selected region: [%i, %i] to [%i, %i]", v2f_expand(editor_ctx.selection.min), v2f_expand(editor_ctx.selection.max));
         igText("number of selected tiles: [%u]", editor_ctx.selection.tiles.size);
     } else {
-        v2i* pos = vector_get(&editor_ctx.selection.tiles, 0);
+        v2i* pos = v2i_vector_get(&editor_ctx.selection.tiles, 0);
         if(!pos) return;
         editor_tile_show_settings(room_get_tile(&editor_ctx.room, pos->x, pos->y));
     }
@@ -968,6 +962,12 @@ static void editor_window_main() {
         igTreePop();
     }
 
+    if(igTreeNode_Str("gfx state")) {
+        gfx_state_stats_t gfx_stats = gfx_state_stats();
+        igText("state changes issued [%u] skipped [%u]", gfx_stats.issued, gfx_stats.skipped);
+        igTreePop();
+    }
+
     if(editor_ctx.alt_mode) igSeparatorText("ALT MODE");
     if(editor_picker_any_active()) igSeparatorText("PICKER MODE");
 
@@ -1007,7 +1007,7 @@ static void resviewer_show_texture_contents(texture_t texture, bool show_image)
         imgui_texture_image(texture, v2f_new(w, h));
     }
 
-    igText("width [%u] height [%u]", texture_data->width, texture_data->height);
+    igText("width [%u] height [%u] layers [%u]", texture_data->width, texture_data->height, texture_data->layers);
 
     igText("format [%s]", format_names[texture_data->format]);
     igText("filter mode [%s]", filter_names[texture_data->filter]);
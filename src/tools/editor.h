@@ -7,6 +7,7 @@
 #include "render/render.h"
 #include "game/camera.h"
 #include "game/room.h"
+#include "memory/typed.h"
 
 typedef enum editor_tool_t {
     EDITOR_TOOL_NONE = 0,
@@ -43,6 +44,8 @@ typedef struct editor_dragger_t {
     v2i max_tile;
 } editor_dragger_t;
 
+VECTOR_DEFINE(v2i)
+
 typedef struct editor_selection_t {
     bool selected;
 
@@ -50,8 +53,8 @@ typedef struct editor_selection_t {
     v2i min;
     v2i max;
 
-    // holds tile grid v2i positions [x, y]
-    vector_t tiles;
+    // tile grid positions [x, y]
+    v2i_vector_t tiles;
 } editor_selection_t;
 
 typedef struct editor_ctx_t {
@@ -0,0 +1,76 @@
+#include "intern.h"
+#include "memory/memory.h"
+
+// the strings live in a virtual arena so they never move,
+// and the map goes from id to the interned copy
+enum {
+    STR_TABLE_RESERVE = MEGABYTES(16),
+    STR_TABLE_INITIAL_CAPACITY = 256,
+};
+
+typedef struct str_table_t {
+    bool initialised;
+    arena_t strings;
+    hashmap_t ids; // str_id_t -> const char*
+} str_table_t;
+
+static str_table_t str_table = {0};
+
+static void str_table_init() {
+    str_table = (str_table_t) {
+        .initialised = true,
+        .strings = arena_virtual_new(STR_TABLE_RESERVE, false),
+        .ids = hashmap_alloc_new_expand(STR_TABLE_INITIAL_CAPACITY, sizeof(u64), sizeof(const char*), EXPAND_TYPE_AUTOEXPAND),
+    };
+}
+
+// has to match STR_ID exactly
+str_id_t str_hash(const char* str) {
+    u32 sum = 0;
+    u32 power = 1;
+    u32 length = 0;
+    for(const char* c = str; *c; c ++) {
+        sum += (u8) *c * power;
+        power *= STR_ID_P;
+        length ++;
+    }
+
+    return STR_ID_MIX(sum ^ length ^ STR_ID_SEED);
+}
+
+str_id_t str_intern(const char* str) {
+    if(!str) return STR_ID_NONE;
+    if(!str_table.initialised) str_table_init();
+
+    str_id_t id = str_hash(str);
+    if(id == STR_ID_NONE) PANIC("[%s] hashes to STR_ID_NONE\n", str);
+
+    const char** existing = hashmap_get_u64(&str_table.ids, id);
+    if(existing) {
+        if(strcmp(*existing, str) != 0) PANIC("string id collision between [%s] and [%s]\n", *existing, str);
+        return id;
+    }
+
+    usize length = strlen(str);
+    char* copy = arena_push(&str_table.strings, length + 1);
+    if(!copy) PANIC("ran out of space interning [%s]\n", str);
+    memcpy(copy, str, length + 1);
+
+    hashmap_put_u64(&str_table.ids, id, &copy);
+    return id;
+}
+
+const char* str_lookup(str_id_t id) {
+    if(!str_table.initialised) return NULL;
+
+    const char** str = hashmap_get_u64(&str_table.ids, id);
+    return str ? *str : NULL;
+}
+
+void str_table_release() {
+    if(!str_table.initialised) return;
+
+    hashmap_destroy(&str_table.ids);
+    arena_destroy(&str_table.strings);
+    str_table = (str_table_t) {0};
+}
@@ -0,0 +1,64 @@
+#ifndef _UTIL_INTERN_H
+#define _UTIL_INTERN_H
+
+#include "base.h"
+
+// STRING INTERNING
+// names (shaders, uniforms, labels, resources) get turned into a u32 id once,
+// so anything that looks them up afterwards compares integers instead of strcmp-ing
+// the id IS the hash of the string, so the same string always gets the same id,
+// across runs too, and STR_ID can work it out at compile time without touching the table
+typedef u32 str_id_t;
+
+#define STR_ID_NONE (0)
+
+// STR_ID only unrolls this many characters, longer literals fail to compile
+#define STR_ID_MAX_LENGTH (64)
+
+// the id for a string literal, ie STR_ID("player-manager")
+// always matches str_hash/str_intern for the same string
+// NOTE(nix3l): this folds down to a constant, but its not an integer constant expression
+// so it cant be used in case labels or static initialisers
+#define STR_ID(_literal) \
+    ((str_id_t) (STR_ID_MIX(STR_ID_SUM64("" _literal) ^ (u32) (sizeof("" _literal) - 1) ^ STR_ID_SEED) + \
+                 0 * sizeof(char[sizeof("" _literal) <= STR_ID_MAX_LENGTH + 1 ? 1 : -1])))
+
+// the same hash at runtime, for strings of any length
+// doesnt add the string to the table
+str_id_t str_hash(const char* str);
+
+// adds the string to the table (copying it) if its not already there, and returns its id
+// panics if two different strings hash to the same id, or a string hashes to STR_ID_NONE
+// NOTE(nix3l): not thread safe, intern things from the main thread (at init time ideally)
+str_id_t str_intern(const char* str);
+// the interned string for the id, or NULL if nothing with that id was interned
+// the pointer stays valid until str_table_release
+const char* str_lookup(str_id_t id);
+
+// frees the table and every interned string
+void str_table_release();
+
+// STR_ID internals
+// the hash is sum(c[i] * P^i) over the characters, run through murmur3's finaliser
+// written out as horner's method so each character only shows up once in the expansion
+// the finaliser maps 0 to 0, so the seed keeps the empty string off STR_ID_NONE
+#define STR_ID_SEED (0x9e3779b9u)
+#define STR_ID_P   (16777619u)
+#define STR_ID_P4  (STR_ID_P * STR_ID_P * STR_ID_P * STR_ID_P)
+#define STR_ID_P16 (STR_ID_P4 * STR_ID_P4 * STR_ID_P4 * STR_ID_P4)
+
+#define STR_ID_C(_s, _i) ((u32) ((_i) < sizeof(_s) - 1 ? (u8) (_s)[(_i) < sizeof(_s) ? (_i) : 0] : 0))
+
+#define STR_ID_SUM4(_s, _i) \
+    (STR_ID_C(_s, _i) + STR_ID_P * (STR_ID_C(_s, _i + 1) + STR_ID_P * (STR_ID_C(_s, _i + 2) + STR_ID_P * STR_ID_C(_s, _i + 3))))
+#define STR_ID_SUM16(_s, _i) \
+    (STR_ID_SUM4(_s, _i) + STR_ID_P4 * (STR_ID_SUM4(_s, _i + 4) + STR_ID_P4 * (STR_ID_SUM4(_s, _i + 8) + STR_ID_P4 * STR_ID_SUM4(_s, _i + 12))))
+#define STR_ID_SUM64(_s) \
+    (STR_ID_SUM16(_s, 0) + STR_ID_P16 * (STR_ID_SUM16(_s, 16) + STR_ID_P16 * (STR_ID_SUM16(_s, 32) + STR_ID_P16 * STR_ID_SUM16(_s, 48))))
+
+#define STR_ID_MIX_1(_h) (((_h) ^ ((_h) >> 16)) * 0x85ebca6bu)
+#define STR_ID_MIX_2(_h) (((_h) ^ ((_h) >> 13)) * 0xc2b2ae35u)
+#define STR_ID_MIX_3(_h) ((_h) ^ ((_h) >> 16))
+#define STR_ID_MIX(_h) STR_ID_MIX_3(STR_ID_MIX_2(STR_ID_MIX_1((u32) (_h))))
+
+#endif
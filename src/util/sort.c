@@ -0,0 +1,89 @@
+#include "sort.h"
+#include "util/util.h"
+
+void insertion_sort_keys(sort_key_t* keys, u32 count) {
+    for(u32 i = 1; i < count; i ++) {
+        sort_key_t current = keys[i];
+
+        u32 j = i;
+        while(j > 0 && keys[j - 1].key > current.key) {
+            keys[j] = keys[j - 1];
+            j --;
+        }
+
+        keys[j] = current;
+    }
+}
+
+enum {
+    RADIX_BITS = 8,
+    RADIX_BUCKETS = 1 << RADIX_BITS,
+    RADIX_PASSES = sizeof(u64) * 8 / RADIX_BITS,
+};
+
+void radix_sort_keys(sort_key_t* keys, u32 count, arena_t* scratch) {
+    if(count < SORT_INSERTION_THRESHOLD) {
+        insertion_sort_keys(keys, count);
+        return;
+    }
+
+    // count every byte of every key in one go, instead of a read per pass
+    u32 histograms[RADIX_PASSES][RADIX_BUCKETS] = {0};
+    for(u32 i = 0; i < count; i ++) {
+        u64 key = keys[i].key;
+        for(u32 pass = 0; pass < RADIX_PASSES; pass ++)
+            histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)] ++;
+    }
+
+    arena_temp_t temp = scratch ? arena_temp_begin(scratch) : scratch_begin(NULL, 0);
+    usize bytes = (usize) count * sizeof(sort_key_t);
+    sort_key_t* heap_buffer = NULL;
+    sort_key_t* buffer = bytes == (u32) bytes ? arena_push_aligned(temp.arena, bytes, CACHE_LINE_SIZE) : NULL;
+    // too big for the scratch arena, goes on the heap instead. slower to get but still linear,
+    // anything quadratic at these sizes would be far worse
+    if(!buffer) {
+        heap_buffer = mem_alloc(bytes);
+        buffer = heap_buffer;
+    }
+
+    sort_key_t* src = keys;
+    sort_key_t* dst = buffer;
+
+    for(u32 pass = 0; pass < RADIX_PASSES; pass ++) {
+        u32* histogram = histograms[pass];
+        u32 shift = pass * RADIX_BITS;
+
+        // every key has the same byte here, so this pass wouldnt move anything
+        if(histogram[(src[0].key >> shift) & (RADIX_BUCKETS - 1)] == count) continue;
+
+        // turn the counts into starting offsets
+        u32 offset = 0;
+        for(u32 i = 0; i < RADIX_BUCKETS; i ++) {
+            u32 bucket_count = histogram[i];
+            histogram[i] = offset;
+            offset += bucket_count;
+        }
+
+        for(u32 i = 0; i < count; i ++)
+            dst[histogram[(src[i].key >> shift) & (RADIX_BUCKETS - 1)] ++] = src[i];
+
+        sort_key_t* tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    // odd number of passes leaves the result in the scratch buffer
+    if(src != keys) memcpy(keys, src, bytes);
+
+    if(heap_buffer) mem_free(heap_buffer);
+    arena_temp_end(temp);
+}
+
+u64 sort_key_f32(f32 value) {
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    // flip every bit of negatives so they sort backwards, and just the sign bit of positives
+    u32 mask = (bits & 0x80000000u) ? 0xffffffffu : 0x80000000u;
+    return bits ^ mask;
+}
@@ -0,0 +1,30 @@
+#ifndef _UTIL_SORT_H
+#define _UTIL_SORT_H
+
+#include "base.h"
+#include "memory/memory.h"
+
+// sorting (key, payload) pairs, ie draw calls by layer/depth/shader or collision pairs by object
+// the payload is usually an index into whatever the keys were made from
+typedef struct sort_key_t {
+    u64 key;
+    u32 payload;
+} sort_key_t;
+
+// below this many keys the radix sort just does an insertion sort
+enum { SORT_INSERTION_THRESHOLD = 64 };
+
+// lsd radix sort, a byte at a time, stable
+// bytes that are the same in every key get skipped, so u32 keys (or anything with the top bits unused)
+// only pay for the bytes they actually use
+// pushes a buffer of `count` keys into scratch and pops it before returning
+// pass NULL to use one of the thread's scratch arenas. if it doesnt fit the buffer comes from the heap
+void radix_sort_keys(sort_key_t* keys, u32 count, arena_t* scratch);
+// stable, only worth it for small or nearly sorted arrays
+void insertion_sort_keys(sort_key_t* keys, u32 count);
+
+// maps a float to a u64 with the same ordering, so it can be used in (or as part of) a sort key
+// negative values sort before positive ones, same as the floats
+u64 sort_key_f32(f32 value);
+
+#endif